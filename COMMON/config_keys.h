@@ -0,0 +1,46 @@
+ /******************************************************************************
+ *
+ * Module: CONFIG
+ *
+ * File Name: config_keys.h
+ *
+ * Description: Configuration keys shared by the HMI_ECU and the Control_ECU
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#ifndef CONFIG_KEYS_H_
+#define CONFIG_KEYS_H_
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Default value of each key, taken by the Control_ECU for a key missing from its
+ * record and by the HMI_ECU when the Control_ECU does not answer a request.
+ */
+#define CONFIG_DEFAULT_MOTOR_RUN_SEC     15
+#define CONFIG_DEFAULT_DOOR_HOLD_SEC     3
+#define CONFIG_DEFAULT_LOCKOUT_SEC       60
+#define CONFIG_DEFAULT_MAX_TRIALS        3
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*
+ * Fixed ID of each configuration value, the IDs are stored in the EEPROM and
+ * sent over the link so they must never be renumbered, new keys are appended.
+ */
+typedef enum
+{
+	CONFIG_KEY_MOTOR_RUN_SEC,	/* door motor run time to open or close the door */
+	CONFIG_KEY_DOOR_HOLD_SEC,	/* time the door is kept open */
+	CONFIG_KEY_LOCKOUT_SEC,		/* lockout time after all the password trials are used */
+	CONFIG_KEY_MAX_TRIALS,		/* password trials before the lockout */
+	CONFIG_NUM_KEYS
+}Config_Key;
+
+#endif /* CONFIG_KEYS_H_ */
@@ -16,7 +16,30 @@
 #include "../MCAL/UART/uart.h"
 #include "../HAL/KEYPAD/keypad.h"
 #include "../MCAL/TIMER/timer.h"
+#include <util/atomic.h>
+#include "ui_text.h"
+#include "../../COMMON/config_keys.h"
 
+/* the Control_ECU may still be starting after the same reset, a request not answered within this time is repeated */
+#define CONTROL_ECU_RETRY_MS       20
+
+/* requests sent before the Control_ECU is taken as missing, 1 second */
+#define CONTROL_ECU_MAX_REQUESTS   50
+
+/* returned instead of a response when the Control_ECU never answered */
+#define CONTROL_ECU_NO_ANSWER      0xFF
+
+/* time allowed for each byte of a response once the Control_ECU is known to be up */
+#define CONTROL_ECU_TIMEOUT_MS     100
+
+/* reset causes in MCUCSR */
+#define RESET_FLAGS_MASK           ((1<<PORF) | (1<<EXTRF) | (1<<BORF) | (1<<WDRF) | (1<<JTRF))
+
+#ifdef KEYPAD_STATS_ENABLE
+/* statistics pages, two entries of a 2 characters tag and a 5 digits value on every LCD row */
+#define STATS_ENTRY_CELLS          8
+#define STATS_ENTRIES_PER_PAGE     4
+#endif
 
 
 /*******************************************************************************
@@ -32,7 +55,7 @@ void setPass(void);
 /*
  * Description :
  * 		This function is responsible for prompting the user for correct passwords,
- * 		within maximum 3 times.
+ * 		within maximum trials.
  * Return:
  * 			1 Password is correct.
  * 		   	0 All trials are used without password being correct
@@ -81,6 +104,13 @@ uint8 isPassMatched(uint8 * pass1, uint8 * pass2, uint8 size);
 char verifyPass_ControlECU(void);
 
 
+/*
+ * Description :
+ * 			The required function to be executed every 1ms by timer0,
+ * 			"counts the uptime and scans the next keypad row"
+ */
+void TIMER0_callback_function(void);
+
 /*
  * Description :
  * 			The required function to be executed when timer interrupt is fired,
@@ -90,9 +120,40 @@ void TIMER1_callback_function(void);
 
 /*
  * Description :
- * 			This function is to generate 15 seconds delay using timer1.
+ * 		This function requests the value of a configuration key from the Control_ECU,
+ * 		default_value is returned if the Control_ECU does not answer in time
+ */
+uint16 getConfig_ControlECU(uint8 key, uint16 default_value);
+
+/*
+ * Description :
+ * 		This function waits at most CONTROL_ECU_TIMEOUT_MS for a byte from the Control_ECU
+ * Return:
+ * 			TRUE if the byte was received into data, FALSE otherwise
+ */
+uint8 receiveByte_ControlECU(uint8 * data);
+
+/*
+ * Description :
+ * 		This function asks the Control_ECU whether a password is already stored,
+ * 		the request is repeated until the Control_ECU is up and answers, at most
+ * 		CONTROL_ECU_MAX_REQUESTS times
+ * Return:
+ * 			TRUE, FALSE or CONTROL_ECU_NO_ANSWER
+ */
+uint8 isPasswordSet_ControlECU(void);
+
+/*
+ * Description :
+ * 			This function returns the milliseconds counted by timer0 since APP_init started
  */
-void TIMER1_delay_15sec(void);
+uint16 getUptime_ms(void);
+
+/*
+ * Description :
+ * 			This function is to generate a delay of the given number of seconds using timer1.
+ */
+void TIMER1_delay_seconds(uint16 seconds);
 
 /*
  * Description :
@@ -100,6 +161,22 @@ void TIMER1_delay_15sec(void);
  */
 void TIMER1_delay_1sec(void);
 
+/*
+ * Description :
+ * 			This function draws the door progress bar on the second row while the motor runs
+ * 			for the given seconds, filling it when opening and emptying it when closing.
+ */
+void showDoorProgress(uint8 seconds, uint8 opening);
+
+#ifdef KEYPAD_STATS_ENABLE
+/*
+ * Description :
+ * 			Bench diagnostics, shows the keypad latency statistics on the LCD page by page,
+ * 			the UART is kept for the Control_ECU.
+ */
+void showKeypadStats(void);
+#endif
+
 
 
 
@@ -109,6 +186,23 @@ void TIMER1_delay_1sec(void);
 
 volatile uint8 ticks = 0; /* used to indicate that required timer ticks are acquired */
 
+/* site configuration, fetched once from the Control_ECU at startup */
+uint8 motor_run_sec;	/* time the door takes to open or close */
+uint8 door_hold_sec;	/* time the door is kept open */
+uint16 lockout_sec;		/* lockout time after all the password trials are used */
+uint8 max_trials;		/* password trials before the lockout */
+
+/* counted by timer0 from the start of APP_init, it wraps after 65 seconds */
+volatile uint16 uptime_ms = 0;
+
+#ifdef KEYPAD_STATS_ENABLE
+/* boot times in ms from the start of APP_init, 0 until reached, latched by the timer0 tick */
+volatile uint16 boot_input_ms = 0;	/* first keypad scan after APP_init returned */
+volatile uint16 boot_frame_ms = 0;	/* the LCD finished the transfers queued by its setup */
+volatile uint8 boot_lcd_ready = FALSE;	/* LCD_init is done, the frame time can be latched */
+volatile uint8 boot_init_done = FALSE;	/* APP_init returned, the input time can be latched */
+#endif
+
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
@@ -123,16 +217,70 @@ void APP_init(void)
 	UART_Config_t config = {UART_8_DATA_BITS, UART_PARITY_DISABLED,
 			UART_1_STOP_BIT, 9600};
 
+	/* Timer0 in CTC mode, 8MHz / 64 / (124 + 1) gives the 1ms keypad scan tick */
+	Timer0_Config_t tick_config = {0, 124, TIMER0_PRESCALER_64, TIMER0_CTC_MODE};
+
+	/* the reset cause, cleared for the next reset */
+	uint8 reset_flags = MCUCSR & RESET_FLAGS_MASK;
+	uint8 password_status;
+
+	MCUCSR &= ~RESET_FLAGS_MASK;
+
 	/* Enable Global Interrupt */
 	SREG |= (1<<7);
 
-	/* initialize LCD, UART modules */
-	LCD_init();
+	/* the tick first, it times the Control_ECU requests and the keys pressed from now on are kept */
+	KEYPAD_init();
+	Timer0_setCallBack(TIMER0_callback_function);
+	Timer0_init(&tick_config);
 	UART_init(&config);
 
-	/* set password at startup */
-	setPass();
+	/* wait for the Control_ECU, the LCD power on time passes meanwhile */
+	password_status = isPasswordSet_ControlECU();
+
+	/*
+	 * The LCD supply only went down with ours on a power on or brown-out reset, otherwise
+	 * the LCD is ready at once. Unknown flags are taken as a power on.
+	 */
+	if((reset_flags & ((1<<PORF) | (1<<BORF))) || (0 == reset_flags))
+	{
+		while(getUptime_ms() < LCD_POWER_ON_DELAY_MS);
+	}
+	LCD_init();
+	LCD_initProgressBar();
+#ifdef KEYPAD_STATS_ENABLE
+	boot_lcd_ready = TRUE;
+#endif
+
+	if(CONTROL_ECU_NO_ANSWER == password_status)
+	{
+		/* nothing works without the Control_ECU, report it and keep asking until it answers */
+		LCD_clearScreen();
+		LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_CONTROL_UNIT));
+		LCD_displayStringRowColumn_P(1, 0, UI_getText(UI_TEXT_NOT_RESPONDING));
+		LCD_flush();
+		do
+		{
+			password_status = isPasswordSet_ControlECU();
+		}while(CONTROL_ECU_NO_ANSWER == password_status);
+		LCD_clearScreen();
+	}
+
+	/* fetch the site timings from the Control_ECU, they are kept in its EEPROM */
+	motor_run_sec = (uint8)getConfig_ControlECU(CONFIG_KEY_MOTOR_RUN_SEC, CONFIG_DEFAULT_MOTOR_RUN_SEC);
+	door_hold_sec = (uint8)getConfig_ControlECU(CONFIG_KEY_DOOR_HOLD_SEC, CONFIG_DEFAULT_DOOR_HOLD_SEC);
+	lockout_sec = getConfig_ControlECU(CONFIG_KEY_LOCKOUT_SEC, CONFIG_DEFAULT_LOCKOUT_SEC);
+	max_trials = (uint8)getConfig_ControlECU(CONFIG_KEY_MAX_TRIALS, CONFIG_DEFAULT_MAX_TRIALS);
 
+	/* the password stored by the Control_ECU survives a restart, only a new system asks for one */
+	if(FALSE == password_status)
+	{
+		setPass();
+	}
+
+#ifdef KEYPAD_STATS_ENABLE
+	boot_init_done = TRUE;
+#endif
 }
 
 /*
@@ -147,13 +295,23 @@ void APP_start(void)
 
 	/* Display main system options */
 	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, " + : Open Door");
-	LCD_displayStringRowColumn(1, 0, " - : Change Pass");
+	LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_MENU_OPEN_DOOR));
+	LCD_displayStringRowColumn_P(1, 0, UI_getText(UI_TEXT_MENU_CHANGE_PASS));
+	LCD_flush();
 
 	/* get user required action, keep prompting till a valid input is entered */
 	do
 	{
 		input = KEYPAD_getPressedKey();
+#ifdef KEYPAD_STATS_ENABLE
+		if('=' == input)
+		{
+			showKeypadStats();
+
+			/* the main menu is drawn again */
+			return;
+		}
+#endif
 	}while(input != '+' && input != '-');
 
 	/* ask user for system password with 3 trials allowance */
@@ -199,15 +357,15 @@ void setPass(void)
 	{
 		/* prompt user for password */
 		LCD_clearScreen();
-		LCD_displayStringRowColumn(0, 0, "Plz enter pass: ");
+		LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_ENTER_PASS));
 		LCD_moveCursor(1, 0);
 
 		/* get the password for the first time */
 		getPass(pass1, &pass1_size);
 
 		/* prompt user to confirm the password */
-		LCD_displayStringRowColumn(0, 0, "Plz re-enter the");
-		LCD_displayStringRowColumn(1, 0, "same pass: ");
+		LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_REENTER_PASS));
+		LCD_displayStringRowColumn_P(1, 0, UI_getText(UI_TEXT_SAME_PASS));
 
 		/* get the password for the second time */
 		getPass(pass2, &pass2_size);
@@ -217,8 +375,9 @@ void setPass(void)
 		{
 			/* if the two passwords are of different sizes, they are already mismatched */
 			LCD_clearScreen();
-			LCD_displayStringRowColumn(0, 0, "Error!! ");
-			LCD_displayStringRowColumn(1, 0, "NOT MATCHED");
+			LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_ERROR));
+			LCD_displayStringRowColumn_P(1, 0, UI_getText(UI_TEXT_NOT_MATCHED));
+			LCD_flush();
 			_delay_ms(1000);
 			continue;
 		}
@@ -232,19 +391,30 @@ void setPass(void)
 			if(matched)
 			{
 				/* if matched, send the password to the Control_ECU to be stored in EEPROM */
-				LCD_displayStringRowColumn(0, 0, "Pass set");
-				LCD_displayStringRowColumn(1, 0, "Successfully");
-
 				UART_sendByte('0');
 				UART_sendString(pass1);
 
+				/* wait for Control_ECU to acknowledge the new password, '0' if it could not store it */
+				if('1' == UART_recieveByte())
+				{
+					LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_PASS_SET));
+					LCD_displayStringRowColumn_P(1, 0, UI_getText(UI_TEXT_SUCCESSFULLY));
+				}
+				else
+				{
+					/* the previous password is kept, prompt from the beginning */
+					LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_ERROR));
+					LCD_displayStringRowColumn_P(1, 0, UI_getText(UI_TEXT_NOT_SAVED));
+					matched = 0;
+				}
 			}
 			else
 			{
 				/* if not matched, print error messages and prompt from the beginning */
-				LCD_displayStringRowColumn(0, 0, "Error!! ");
-				LCD_displayStringRowColumn(1, 0, "NOT MATCHED");
+				LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_ERROR));
+				LCD_displayStringRowColumn_P(1, 0, UI_getText(UI_TEXT_NOT_MATCHED));
 			}
+			LCD_flush();
 			TIMER1_delay_1sec();
 		}
 	}while(!matched); /* keep prompting for a correct password to be set */
@@ -254,14 +424,14 @@ void setPass(void)
 /*
  * Description :
  * 		This function is responsible for prompting the user for correct passwords,
- * 		within maximum 3 times.
+ * 		within maximum trials.
  * Return:
  * 			1 Password is correct.
  * 		   	0 All trials are used without password being correct
  */
 uint8 checkPassword_trials(void)
 {
-	uint8 maxTrials = 3;
+	uint8 maxTrials = max_trials;
 	uint8 isCorrect;
 
 	while(maxTrials--)
@@ -276,18 +446,20 @@ uint8 checkPassword_trials(void)
 		{
 			/* password is correct */
 			LCD_clearScreen();
-			LCD_displayStringRowColumn(0, 0, "ACCESS GRANTED");
+			LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_ACCESS_GRANTED));
+			LCD_flush();
 			TIMER1_delay_1sec();
 			return 1;
 		}
 		else{
 		/* if password is false */
 		LCD_clearScreen();
-		LCD_displayStringRowColumn(0, 0, "ACCESS DENIED");
+		LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_ACCESS_DENIED));
+		LCD_flush();
 		TIMER1_delay_1sec();
 		}
 	}
-	/* all 3 trials are used without password being correct */
+	/* all the trials are used without password being correct */
 	return 0;
 }
 
@@ -297,31 +469,35 @@ uint8 checkPassword_trials(void)
  */
 void openDoor(void)
 {
-	int count_down = 3;
+	uint8 count_down = door_hold_sec;
 	/* Send a command to control_ECU to open the door */
 	UART_sendByte('2');
-	/* display opening message for 15 seconds */
+	/* display opening message while the motor runs */
 	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "Door is Unlocking");
-	TIMER1_delay_15sec();
+	LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_DOOR_UNLOCKING));
+	showDoorProgress(motor_run_sec, TRUE);
 
 	/* display time remaining to lock the door */
 	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "Door locks in");
-	LCD_displayStringRowColumn(1, 8, "3");
+	LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_DOOR_LOCKS_IN));
+	LCD_moveCursor(1, 8);
+	LCD_displayNumber(count_down, 3, FORMAT_PAD_SPACE);
+	LCD_flush();
 
 	while(count_down--)
 	{
 		/* update count_down variable every 1 second */
 		TIMER1_delay_1sec();
+		/* a fixed width field overwrites the previous value, no blanking needed */
 		LCD_moveCursor(1, 8);
-		LCD_intgerToString(count_down);
+		LCD_displayNumber(count_down, 3, FORMAT_PAD_SPACE);
+		LCD_flush();	/* only the changed digits are sent */
 	}
 
 	/* display locking the door warning */
 	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "Door is locking  ");
-	TIMER1_delay_15sec();
+	LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_DOOR_LOCKING));
+	showDoorProgress(motor_run_sec, FALSE);
 }
 
 /*
@@ -330,21 +506,18 @@ void openDoor(void)
  */
 void lockSystem(void)
 {
-	int timer_counter = 0; /* used to repeat the 15sec delay function to get 1 min*/
-	/* activate buzzer for 1 minute "send relative signal to control_mcu" */
+	/* activate buzzer for the lockout time "send relative signal to control_mcu" */
 	UART_sendByte('3');
 
-	/* display error message on lcd for 1 minute */
+	/* display error message on lcd for the lockout time */
 	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "MAX TRIALS USED");
-	LCD_displayStringRowColumn(1, 0, "SYSTEM IS LOCKED");
+	LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_MAX_TRIALS_USED));
+	LCD_displayStringRowColumn_P(1, 0, UI_getText(UI_TEXT_SYSTEM_LOCKED));
+	LCD_flush();
 	/* no input received */
 
-	/* Delay 1 minute */
-	while(timer_counter++ < 4)
-	{
-		TIMER1_delay_15sec();
-	}
+	/* Delay the lockout time */
+	TIMER1_delay_seconds(lockout_sec);
 }
 
 
@@ -364,7 +537,7 @@ char verifyPass_ControlECU(void)
 
 	/* prompt for password */
 	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "Plz enter pass:");
+	LCD_displayStringRowColumn_P(0, 0, UI_getText(UI_TEXT_ENTER_PASS));
 	LCD_moveCursor(1, 0);
 
 	/* get user entered password */
@@ -381,6 +554,118 @@ char verifyPass_ControlECU(void)
 }
 
 
+/*
+ * Description :
+ * 		This function requests the value of a configuration key from the Control_ECU,
+ * 		default_value is returned if the Control_ECU does not answer in time
+ * 		Request: '4' [key]   Response: [value low byte] [value high byte]
+ */
+uint16 getConfig_ControlECU(uint8 key, uint16 default_value)
+{
+	uint8 low, high;
+
+	UART_sendByte('4');
+	UART_sendByte(key);
+
+	if(!receiveByte_ControlECU(&low) || !receiveByte_ControlECU(&high))
+	{
+		return default_value;
+	}
+
+	return ((uint16)high << 8) | low;
+}
+
+/*
+ * Description :
+ * 		This function waits at most CONTROL_ECU_TIMEOUT_MS for a byte from the Control_ECU
+ * Return:
+ * 			TRUE if the byte was received into data, FALSE otherwise
+ */
+uint8 receiveByte_ControlECU(uint8 * data)
+{
+	uint16 start_ms = getUptime_ms();
+
+	while(!UART_isByteReceived())
+	{
+		if((uint16)(getUptime_ms() - start_ms) >= CONTROL_ECU_TIMEOUT_MS)
+		{
+			return FALSE;
+		}
+	}
+	*data = UART_recieveByte();
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * 		This function asks the Control_ECU whether a password is already stored,
+ * 		the request is repeated until the Control_ECU is up and answers, at most
+ * 		CONTROL_ECU_MAX_REQUESTS times
+ * 		Request: '8'   Response: '1' stored, '0' none
+ * Return:
+ * 			TRUE, FALSE or CONTROL_ECU_NO_ANSWER
+ */
+uint8 isPasswordSet_ControlECU(void)
+{
+	uint16 sent_ms;
+	uint8 requests = 0;
+	uint8 status;
+
+	/* drop any noise received while the lines came up */
+	while(UART_isByteReceived())
+	{
+		UART_recieveByte();
+	}
+
+	do
+	{
+		UART_sendByte('8');
+		requests++;
+		sent_ms = getUptime_ms();
+		while(!UART_isByteReceived() && ((uint16)(getUptime_ms() - sent_ms) < CONTROL_ECU_RETRY_MS));
+	}while(!UART_isByteReceived() && (requests < CONTROL_ECU_MAX_REQUESTS));
+
+	if(!UART_isByteReceived())
+	{
+		return CONTROL_ECU_NO_ANSWER;
+	}
+	status = UART_recieveByte();
+
+	/* a repeated request may still be answered late, drop it before the next request */
+	if(requests > 1)
+	{
+		sent_ms = getUptime_ms();
+		while((uint16)(getUptime_ms() - sent_ms) < CONTROL_ECU_RETRY_MS)
+		{
+			if(UART_isByteReceived())
+			{
+				UART_recieveByte();
+			}
+		}
+	}
+
+	return ('1' == status) ? TRUE : FALSE;
+}
+
+/*
+ * Description :
+ * 			This function returns the milliseconds counted by timer0 since APP_init started
+ */
+uint16 getUptime_ms(void)
+{
+	uint16 ms;
+
+	/* the 2 bytes are read one by one, keep the timer0 interrupt from changing them in between */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ms = uptime_ms;
+	}
+
+	return ms;
+}
+
+
 /*
  * Description :
  * 		This function is responsible for storing the user entered password,
@@ -388,18 +673,26 @@ char verifyPass_ControlECU(void)
  */
 void getPass(uint8 * passArr, uint8 * size)
 {
-	_delay_ms(100);
+	/* show the prompt drawn by the caller */
+	LCD_flush();
+
 	*size = 0;
 	do
 	{
 		passArr[(*size)++] = KEYPAD_getPressedKey();	/* store the entered keypad character in the array,
 														   increment its size */
 		if(passArr[(*size) - 1] != 13)
+		{
 			LCD_displayCharacter('*');		/* print '*' on LCD in place of the entered keypad value, ignore ON key press */
+			LCD_flush();
+#ifdef KEYPAD_STATS_ENABLE
+			/* the echo is timed when the LCD tick writes the '*', not when it is queued */
+			LCD_setWrittenCallBack(KEYPAD_STATS_markEcho);
+#endif
+		}
 
-		_delay_ms(250);				/* wait 100ms between two keypad presses */
-
-		/* keep storing characters till ON key is pressed */
+		/* keep storing characters till ON key is pressed, the keypad scanner debounces every key
+		 * and reports a press only once so no delay is needed between two presses */
 	}while(passArr[(*size) - 1] != 13); /* 13 is ASCII of Enter, returned by keypad if ON is pressed */
 
 	passArr[--(*size)] = '\0'; /* terminate input string by null character, remove the enter character */
@@ -436,18 +729,23 @@ uint8 isPassMatched(uint8 * pass1, uint8 * pass2, uint8 size)
 
 /*
  * Description :
- * 			This function is to generate 15 seconds delay using timer1.
+ * 			This function is to generate a delay of the given number of seconds using timer1.
  */
-void TIMER1_delay_15sec(void)
+void TIMER1_delay_seconds(uint16 seconds)
 {
-	/* 118880 == 58594*/
-	Timer1_Config_t config = { 1000 , 58594, TIMER1_PRESCALER_1024, TIMER1_CTC_MODE};
+	/* required OCR value to generate 1 second at 1024 pre-scaler is 7813*/
+	Timer1_Config_t config = { 1000 , 7813, TIMER1_PRESCALER_1024, TIMER1_CTC_MODE};
+	ticks = 0;
 	Timer1_init(&config);
 	Timer1_setCallBack(TIMER1_callback_function);
-	while(ticks < 2);
-	ticks = 0;
-	Timer1_deInit();
 
+	/* count the seconds, the timer keeps running so no time is lost between them */
+	while(seconds--)
+	{
+		while(!ticks);
+		ticks = 0;
+	}
+	Timer1_deInit();
 }
 
 /*
@@ -459,6 +757,7 @@ void TIMER1_delay_1sec(void)
 	/* required OCR value to generate 1 second at 1024 pre-scaler is 7813*/
 	/* Timer will run in CTC, so we can put any dummy number in TCNT1 for the config*/
 	Timer1_Config_t config = { 1000 , 7813, TIMER1_PRESCALER_1024, TIMER1_CTC_MODE};
+	ticks = 0;
 	Timer1_init(&config);
 
 	/* set timer callback function */
@@ -474,10 +773,141 @@ void TIMER1_delay_1sec(void)
 
 }
 
+/*
+ * Description :
+ * 			This function draws the door progress bar on the second row while the motor runs
+ * 			for the given seconds, filling it when opening and emptying it when closing.
+ */
+void showDoorProgress(uint8 seconds, uint8 opening)
+{
+	uint8 steps = LCD_NUM_COLS * LCD_BAR_STEPS_PER_CELL;
+	uint8 step;
+	/* 7813 counts of the 1024 pre-scaler make 1 second, shared by the bar steps */
+	Timer1_Config_t config = { 0 , 0, TIMER1_PRESCALER_1024, TIMER1_CTC_MODE};
+
+	config.compare_value = (uint16)(((uint32)seconds * 7813) / steps);
+
+	LCD_displayProgressBar(1, 0, LCD_NUM_COLS, opening ? 0 : steps);
+	LCD_flush();
+
+	/* a tick left from an earlier use of timer1 would fire the first step at once */
+	ticks = 0;
+	Timer1_init(&config);
+	Timer1_setCallBack(TIMER1_callback_function);
+
+	/* one more or one less pixel column per step, only that cell is sent to the screen */
+	for(step = 1; step <= steps; step++)
+	{
+		while(!ticks);
+		ticks = 0;
+		LCD_displayProgressBar(1, 0, LCD_NUM_COLS, opening ? step : (steps - step));
+		LCD_flush();
+	}
+	Timer1_deInit();
+}
+
+/*
+ * Description :
+ * 			The required function to be executed every 1ms by timer0,
+ * 			"counts the uptime and scans the next keypad row"
+ */
+void TIMER0_callback_function(void)
+{
+	uptime_ms++;
+	KEYPAD_scanTask();
+
+#ifdef KEYPAD_STATS_ENABLE
+	/* the boot times are taken here so the application never waits for them */
+	if(boot_lcd_ready && (0 == boot_frame_ms) && LCD_isIdle())
+	{
+		boot_frame_ms = uptime_ms;
+	}
+	if(boot_init_done && (0 == boot_input_ms))
+	{
+		boot_input_ms = uptime_ms;
+	}
+#endif
+}
+
 void TIMER1_callback_function(void)
 {
 	ticks++;
 }
 
+#ifdef KEYPAD_STATS_ENABLE
+/*
+ * Description :
+ * 			Display a statistics entry of STATS_ENTRY_CELLS cells: its 2 characters tag and the value.
+ */
+static void showStatsEntry(char tag0, char tag1, uint16 value)
+{
+	LCD_displayCharacter(tag0);
+	LCD_displayCharacter(tag1);
+	LCD_displayCharacter(' ');
+	LCD_displayNumber(value, 5, FORMAT_PAD_SPACE);
+}
+
+/*
+ * Description :
+ * 			Bench diagnostics, shows the keypad latency statistics on the LCD page by page,
+ * 			the UART is kept for the Control_ECU. Every page holds STATS_ENTRIES_PER_PAGE
+ * 			entries and a key press shows the next one. Every histogram starts with a title
+ * 			page telling what it measures and its bin width, its entries are tagged with
+ * 			's' scan time, 'p' press delay or 'e' echo delay and the bin in hex.
+ * 			The last page holds the boot times "bi" input and "bf" frame,
+ * 			the missed "mi" and the duplicate "du" presses.
+ */
+void showKeypadStats(void)
+{
+	KEYPAD_Stats_t stats;
+	const uint16 * histogram[3];
+	const char tag[3] = {'s', 'p', 'e'};
+	const char * const title[3][2] =
+	{
+		{"s SCAN 8us/BIN",  "TICK TO SCAN END"},
+		{"p PRESS 2ms/BIN", "CONTACT TO PRESS"},
+		{"e ECHO 1ms/BIN",  "PRESS TO LCD"}
+	};
+	const char hex[] = "0123456789ABCDEF";
+	uint8 i, bin, entry;
+
+	KEYPAD_STATS_get(&stats);
+	histogram[0] = stats.scan_time;
+	histogram[1] = stats.press_delay;
+	histogram[2] = stats.echo_delay;
+
+	for(i = 0; i < 3; i++)
+	{
+		LCD_clearScreen();
+		LCD_displayStringRowColumn(0, 0, title[i][0]);
+		LCD_displayStringRowColumn(1, 0, title[i][1]);
+		LCD_flush();
+		KEYPAD_getPressedKey();
+
+		for(bin = 0; bin < KEYPAD_STATS_NUM_BINS; bin += STATS_ENTRIES_PER_PAGE)
+		{
+			LCD_clearScreen();
+			for(entry = 0; (entry < STATS_ENTRIES_PER_PAGE) && ((bin + entry) < KEYPAD_STATS_NUM_BINS); entry++)
+			{
+				LCD_moveCursor(entry / 2, (entry % 2) * STATS_ENTRY_CELLS);
+				showStatsEntry(tag[i], hex[bin + entry], histogram[i][bin + entry]);
+			}
+			LCD_flush();
+			KEYPAD_getPressedKey();
+		}
+	}
+
+	LCD_clearScreen();
+	LCD_moveCursor(0, 0);
+	showStatsEntry('b', 'i', boot_input_ms);
+	showStatsEntry('b', 'f', boot_frame_ms);
+	LCD_moveCursor(1, 0);
+	showStatsEntry('m', 'i', stats.missed);
+	showStatsEntry('d', 'u', stats.duplicates);
+	LCD_flush();
+	KEYPAD_getPressedKey();
+}
+#endif
+
 
 
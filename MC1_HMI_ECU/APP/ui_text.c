@@ -0,0 +1,74 @@
+/******************************************************************************
+ *
+ * Module: UI_TEXT
+ *
+ * File Name: ui_text.c
+ *
+ * Description: Source file for the HMI user interface text table
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+#include "ui_text.h"
+#include <avr/pgmspace.h>	/* the texts stay in flash, they are not copied to SRAM at startup */
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static const char g_text_menu_open_door[] PROGMEM   = " + : Open Door";
+static const char g_text_menu_change_pass[] PROGMEM = " - : Change Pass";
+static const char g_text_enter_pass[] PROGMEM       = "Plz enter pass:";
+static const char g_text_reenter_pass[] PROGMEM     = "Plz re-enter the";
+static const char g_text_same_pass[] PROGMEM        = "same pass: ";
+static const char g_text_error[] PROGMEM            = "Error!! ";
+static const char g_text_not_matched[] PROGMEM      = "NOT MATCHED";
+static const char g_text_not_saved[] PROGMEM        = "NOT SAVED";
+static const char g_text_pass_set[] PROGMEM         = "Pass set";
+static const char g_text_successfully[] PROGMEM     = "Successfully";
+static const char g_text_access_granted[] PROGMEM   = "ACCESS GRANTED";
+static const char g_text_access_denied[] PROGMEM    = "ACCESS DENIED";
+static const char g_text_door_unlocking[] PROGMEM   = "Door is Unlocking";
+static const char g_text_door_locks_in[] PROGMEM    = "Door locks in";
+static const char g_text_door_locking[] PROGMEM     = "Door is locking";
+static const char g_text_max_trials_used[] PROGMEM  = "MAX TRIALS USED";
+static const char g_text_system_locked[] PROGMEM    = "SYSTEM IS LOCKED";
+static const char g_text_control_unit[] PROGMEM     = "Control unit";
+static const char g_text_not_responding[] PROGMEM   = "not responding";
+
+/* indexed by UI_TextId, the table itself is in flash as well */
+static const char * const g_ui_text[UI_TEXT_NUM] PROGMEM =
+{
+	g_text_menu_open_door,
+	g_text_menu_change_pass,
+	g_text_enter_pass,
+	g_text_reenter_pass,
+	g_text_same_pass,
+	g_text_error,
+	g_text_not_matched,
+	g_text_not_saved,
+	g_text_pass_set,
+	g_text_successfully,
+	g_text_access_granted,
+	g_text_access_denied,
+	g_text_door_unlocking,
+	g_text_door_locks_in,
+	g_text_door_locking,
+	g_text_max_trials_used,
+	g_text_system_locked,
+	g_text_control_unit,
+	g_text_not_responding
+};
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Return the flash address of the text, to be used with the _P string functions
+ */
+const char * UI_getText(UI_TextId id)
+{
+	return (const char *)pgm_read_word(&g_ui_text[id]);
+}
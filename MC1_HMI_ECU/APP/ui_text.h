@@ -0,0 +1,57 @@
+/******************************************************************************
+ *
+ * Module: UI_TEXT
+ *
+ * File Name: ui_text.h
+ *
+ * Description: Header file for the HMI user interface text table
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#ifndef UI_TEXT_H_
+#define UI_TEXT_H_
+
+#include "../std_types.h"
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Every text shown by the HMI, in the order of the table in ui_text.c */
+typedef enum
+{
+	UI_TEXT_MENU_OPEN_DOOR,
+	UI_TEXT_MENU_CHANGE_PASS,
+	UI_TEXT_ENTER_PASS,
+	UI_TEXT_REENTER_PASS,
+	UI_TEXT_SAME_PASS,
+	UI_TEXT_ERROR,
+	UI_TEXT_NOT_MATCHED,
+	UI_TEXT_NOT_SAVED,
+	UI_TEXT_PASS_SET,
+	UI_TEXT_SUCCESSFULLY,
+	UI_TEXT_ACCESS_GRANTED,
+	UI_TEXT_ACCESS_DENIED,
+	UI_TEXT_DOOR_UNLOCKING,
+	UI_TEXT_DOOR_LOCKS_IN,
+	UI_TEXT_DOOR_LOCKING,
+	UI_TEXT_MAX_TRIALS_USED,
+	UI_TEXT_SYSTEM_LOCKED,
+	UI_TEXT_CONTROL_UNIT,
+	UI_TEXT_NOT_RESPONDING,
+	UI_TEXT_NUM
+}UI_TextId;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Return the flash address of the text, to be used with the _P string functions
+ */
+const char * UI_getText(UI_TextId id);
+
+#endif /* UI_TEXT_H_ */
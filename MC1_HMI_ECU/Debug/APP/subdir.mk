@@ -4,13 +4,16 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
-../APP/app.c 
+../APP/app.c \
+../APP/ui_text.c 
 
 OBJS += \
-./APP/app.o 
+./APP/app.o \
+./APP/ui_text.o 
 
 C_DEPS += \
-./APP/app.d 
+./APP/app.d \
+./APP/ui_text.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
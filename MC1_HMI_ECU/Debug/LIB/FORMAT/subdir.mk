@@ -0,0 +1,24 @@
+################################################################################
+# Automatically-generated file. Do not edit!
+################################################################################
+
+# Add inputs and outputs from these tool invocations to the build variables 
+C_SRCS += \
+../LIB/FORMAT/format.c 
+
+OBJS += \
+./LIB/FORMAT/format.o 
+
+C_DEPS += \
+./LIB/FORMAT/format.d 
+
+
+# Each subdirectory must supply rules for building sources it contributes
+LIB/FORMAT/%.o: ../LIB/FORMAT/%.c LIB/FORMAT/subdir.mk
+	@echo 'Building file: $<'
+	@echo 'Invoking: AVR Compiler'
+	avr-gcc -Wall -g2 -gstabs -O0 -fpack-struct -fshort-enums -ffunction-sections -fdata-sections -std=gnu99 -funsigned-char -funsigned-bitfields -mmcu=atmega32 -DF_CPU=8000000UL -MMD -MP -MF"$(@:%.o=%.d)" -MT"$@" -c -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+
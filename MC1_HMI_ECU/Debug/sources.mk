@@ -23,8 +23,12 @@ SUBDIRS := \
 APP \
 HAL/KEYPAD \
 HAL/LCD \
+LIB/FORMAT \
 . \
+MCAL/ADC \
+MCAL/EXT_INT \
 MCAL/GPIO \
 MCAL/TIMER \
+MCAL/TWI \
 MCAL/UART \
 
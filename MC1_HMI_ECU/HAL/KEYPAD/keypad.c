@@ -11,12 +11,170 @@
  *******************************************************************************/
 #include "keypad.h"
 #include "../../MCAL/GPIO/gpio.h"
-#include <util/delay.h>
+#include "../../MCAL/EXT_INT/ext_int.h"
+#if (KEYPAD_BACKEND == KEYPAD_ADC_LADDER_BACKEND)
+#include "../../MCAL/ADC/adc.h"
+#endif
+#if (KEYPAD_BACKEND == KEYPAD_MATRIX_BACKEND)
+#include "../../MCAL/UART/uart.h"	/* power-down waits for the UART and the LCD queue */
+#include "../LCD/lcd.h"
+#endif
+#ifdef KEYPAD_STATS_ENABLE
+#include "../../MCAL/TIMER/timer.h"
+#endif
+#include <avr/io.h>		/* the scan accesses the port registers directly */
+#include <avr/interrupt.h>	/* to close the race between the wake-up interrupt and sleep */
+#include <avr/sleep.h>
+#include <util/atomic.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#if (KEYPAD_BACKEND == KEYPAD_MATRIX_BACKEND)
+/*
+ * The scan runs in the timer ISR, so the rows and columns are accessed with one
+ * masked register operation each instead of a GPIO driver call per pin.
+ */
+#if (KEYPAD_ROW_PORT_ID == PORTA_ID)
+#define KEYPAD_ROW_DDR      DDRA
+#define KEYPAD_ROW_PORT     PORTA
+#elif (KEYPAD_ROW_PORT_ID == PORTB_ID)
+#define KEYPAD_ROW_DDR      DDRB
+#define KEYPAD_ROW_PORT     PORTB
+#elif (KEYPAD_ROW_PORT_ID == PORTC_ID)
+#define KEYPAD_ROW_DDR      DDRC
+#define KEYPAD_ROW_PORT     PORTC
+#elif (KEYPAD_ROW_PORT_ID == PORTD_ID)
+#define KEYPAD_ROW_DDR      DDRD
+#define KEYPAD_ROW_PORT     PORTD
+#endif
+
+#if (KEYPAD_COL_PORT_ID == PORTA_ID)
+#define KEYPAD_COL_DDR      DDRA
+#define KEYPAD_COL_PIN      PINA
+#elif (KEYPAD_COL_PORT_ID == PORTB_ID)
+#define KEYPAD_COL_DDR      DDRB
+#define KEYPAD_COL_PIN      PINB
+#elif (KEYPAD_COL_PORT_ID == PORTC_ID)
+#define KEYPAD_COL_DDR      DDRC
+#define KEYPAD_COL_PIN      PINC
+#elif (KEYPAD_COL_PORT_ID == PORTD_ID)
+#define KEYPAD_COL_DDR      DDRD
+#define KEYPAD_COL_PIN      PIND
+#endif
+
+#define KEYPAD_ROWS_MASK    ((uint8)(((1u << KEYPAD_NUM_ROWS) - 1) << KEYPAD_FIRST_ROW_PIN_ID))
+#define KEYPAD_COLS_MASK    ((uint8)(((1u << KEYPAD_NUM_COLS) - 1) << KEYPAD_FIRST_COL_PIN_ID))
+
+/* Wake-up edge of the wired-OR column line */
+#if (KEYPAD_BUTTON_PRESSED == LOGIC_LOW)
+#define KEYPAD_WAKE_SENSE   EXT_INT_FALLING_EDGE
+#else
+#define KEYPAD_WAKE_SENSE   EXT_INT_RISING_EDGE
+#endif
+#endif /* KEYPAD_MATRIX_BACKEND */
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+#if (KEYPAD_BACKEND == KEYPAD_MATRIX_BACKEND)
+/* row driven low, its columns are sampled on the next tick */
+static uint8 g_keypad_row = 0;
+#else
+/*
+ * Upper ADC reading of every ladder level, in increasing order, generated from
+ * the ladder step at compile time. A reading above the last one is no key.
+ */
+static const uint16 g_keypad_thresholds[KEYPAD_NUM_KEYS] =
+{
+	KEYPAD_LADDER_THRESHOLD(0),  KEYPAD_LADDER_THRESHOLD(1),  KEYPAD_LADDER_THRESHOLD(2),  KEYPAD_LADDER_THRESHOLD(3),
+	KEYPAD_LADDER_THRESHOLD(4),  KEYPAD_LADDER_THRESHOLD(5),  KEYPAD_LADDER_THRESHOLD(6),  KEYPAD_LADDER_THRESHOLD(7),
+	KEYPAD_LADDER_THRESHOLD(8),  KEYPAD_LADDER_THRESHOLD(9),  KEYPAD_LADDER_THRESHOLD(10), KEYPAD_LADDER_THRESHOLD(11),
+#if (KEYPAD_NUM_KEYS == 16)
+	KEYPAD_LADDER_THRESHOLD(12), KEYPAD_LADDER_THRESHOLD(13), KEYPAD_LADDER_THRESHOLD(14), KEYPAD_LADDER_THRESHOLD(15)
+#endif
+};
+#endif
+
+/* debounce integrator of every key, counts towards KEYPAD_DEBOUNCE_SAMPLES while pressed */
+static uint8 g_keypad_integrator[KEYPAD_NUM_KEYS];
+
+/* debounced state, bit n set while key n is pressed */
+static uint16 g_keypad_state = 0;
+
+/* scan ticks since the last key activity, and TRUE while the keypad waits for the wake-up interrupt */
+static volatile uint16 g_keypad_quiet_ticks = 0;
+static volatile uint8 g_keypad_sleeping = FALSE;
+
+/* event FIFO, filled by the scan tick and emptied by the application */
+static volatile KEYPAD_Event_t g_keypad_events[KEYPAD_EVENT_QUEUE_SIZE];
+static volatile uint8 g_keypad_head = 0;
+static volatile uint8 g_keypad_tail = 0;
+
+#ifdef KEYPAD_STATS_ENABLE
+static volatile uint16 g_stats_ticks = 0;		/* scan ticks, the time base of the statistics */
+static uint16 g_stats_contact[KEYPAD_NUM_KEYS];	/* tick of the first contact of every key */
+static uint16 g_stats_release[KEYPAD_NUM_KEYS];	/* tick of the last release of every key */
+static uint16 g_stats_last_press;				/* tick of the press returned last by KEYPAD_getPressedKey */
+static KEYPAD_Stats_t g_stats;
+#endif
 
 /*******************************************************************************
  *                      Functions Prototypes(Private)                          *
  *******************************************************************************/
 
+/*
+ * Function responsible for mapping the key index of the scan to its key value
+ */
+static uint8 KEYPAD_getKeyValue(uint8 key_index);
+
+/*
+ * Function responsible for adding an event to the queue, the event is dropped if the queue is full
+ */
+static void KEYPAD_pushEvent(uint8 key_index, KEYPAD_EventType type);
+
+/*
+ * Function responsible for debouncing one sample of a key and queuing its press and release events
+ */
+static void KEYPAD_debounceKey(uint8 key_index, uint8 is_pressed);
+
+#if (KEYPAD_BACKEND == KEYPAD_MATRIX_BACKEND)
+/*
+ * Function responsible for driving one row with the pressed level, the other rows are released
+ */
+static void KEYPAD_driveRow(uint8 row);
+
+/*
+ * Wake-up interrupt callback, leaves the idle mode and restarts the scan
+ */
+static void KEYPAD_wakeUp(void);
+#else
+/*
+ * Function responsible for finding the key index of a ladder reading, KEYPAD_NUM_KEYS if no key is pressed
+ */
+static uint8 KEYPAD_ladderKey(uint16 adc_value);
+#endif
+
+#ifdef KEYPAD_STATS_ENABLE
+/*
+ * Count the scan tick
+ */
+static void KEYPAD_STATS_tick(void);
+
+/*
+ * Measure the time from the tick to the end of its scan with the Timer0 count,
+ * it is cleared by the compare match that started the tick
+ */
+static void KEYPAD_STATS_scanDone(void);
+
+/*
+ * Add one sample to the bin of a histogram, the last bin collects the overflow
+ */
+static void KEYPAD_STATS_addSample(uint16 * histogram, uint16 bin);
+#endif
+
 #ifndef STANDARD_KEYPAD
 
 #if (KEYPAD_NUM_COLS == 3)
@@ -39,58 +197,433 @@ static uint8 KEYPAD_4x4_adjustKeyNumber(uint8 button_number);
  *                      Functions Definitions                                  *
  *******************************************************************************/
 
-uint8 KEYPAD_getPressedKey(void)
+/*
+ * Description :
+ * Setup the keypad pins and start the scan from the first row
+ */
+void KEYPAD_init(void)
+{
+#if (KEYPAD_BACKEND == KEYPAD_MATRIX_BACKEND)
+	/* all the columns are inputs */
+	KEYPAD_COL_DDR &= ~KEYPAD_COLS_MASK;
+
+	/* drive the first row, it is sampled on the first tick */
+	g_keypad_row = 0;
+	KEYPAD_driveRow(g_keypad_row);
+#else
+	/* the ADC converts the ladder continuously, a conversion takes 104us at 125kHz so every tick finds a fresh one */
+	ADC_Config_t adc_config = {ADC_AVCC, ADC_F_CPU_64};
+
+	DDRA &= ~(1u << KEYPAD_ADC_CHANNEL);
+	ADC_init(&adc_config);
+	ADC_startFreeRunning(KEYPAD_ADC_CHANNEL);
+#endif
+}
+
+/*
+ * Description :
+ * Scan the keypad, to be called from a periodic timer tick (1ms).
+ * Matrix: the row driven by the previous call had the whole tick to settle, the
+ * columns are sampled, the keys of the row are debounced and the next row is driven.
+ * ADC ladder: the last free running conversion gives the pressed key, if any.
+ */
+void KEYPAD_scanTask(void)
 {
-	uint8 col,row;
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+1, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+2, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+3, PIN_INPUT);
+#if (KEYPAD_BACKEND == KEYPAD_MATRIX_BACKEND)
+	uint8 col, pressed;
+#else
+	uint8 key_index, pressed_index;
+#endif
+
+	/* all the rows are driven in the idle mode, nothing to scan until the wake-up interrupt */
+	if(g_keypad_sleeping)
+	{
+		return;
+	}
 
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID+1, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID+2, PIN_INPUT);
-#if(KEYPAD_NUM_COLS == 4)
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID+3, PIN_INPUT);
+#ifdef KEYPAD_STATS_ENABLE
+	KEYPAD_STATS_tick();
 #endif
-	while(1)
+
+	/* count the quiet time while all the keys are released */
+	if(g_keypad_state)
 	{
-		for(row=0 ; row<KEYPAD_NUM_ROWS ; row++) /* loop for rows */
+		g_keypad_quiet_ticks = 0;
+	}
+	else if(g_keypad_quiet_ticks < KEYPAD_IDLE_TIMEOUT_TICKS)
+	{
+		g_keypad_quiet_ticks++;
+	}
+
+#if (KEYPAD_BACKEND == KEYPAD_MATRIX_BACKEND)
+	/* sample all the columns of the row with one port read, bit n set if column n is pressed */
+	pressed = (KEYPAD_COL_PIN & KEYPAD_COLS_MASK) >> KEYPAD_FIRST_COL_PIN_ID;
+#if (KEYPAD_BUTTON_PRESSED == LOGIC_LOW)
+	pressed = ~pressed;
+#endif
+
+	for(col = 0; col < KEYPAD_NUM_COLS; col++)
+	{
+		KEYPAD_debounceKey((g_keypad_row * KEYPAD_NUM_COLS) + col, (pressed & (1u << col)) ? TRUE : FALSE);
+	}
+
+	/* release this row and drive the next one */
+	g_keypad_row = (g_keypad_row + 1) % KEYPAD_NUM_ROWS;
+	KEYPAD_driveRow(g_keypad_row);
+#else
+	/* one conversion reads the whole keypad, only one key can be seen at a time */
+	pressed_index = KEYPAD_ladderKey(ADC_getResult());
+
+	/* the released keys with an empty integrator have nothing to debounce */
+	for(key_index = 0; key_index < KEYPAD_NUM_KEYS; key_index++)
+	{
+		if((key_index == pressed_index) || g_keypad_integrator[key_index])
 		{
-			/*
-			 * Each time setup the direction for all keypad port as input pins,
-			 * except this row will be output pin
-			 */
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,KEYPAD_FIRST_ROW_PIN_ID+row,PIN_OUTPUT);
-
-			/* Set/Clear the row output pin */
-			GPIO_writePin(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+row, KEYPAD_BUTTON_PRESSED);
-			_delay_ms(5);
-			for(col=0 ; col<KEYPAD_NUM_COLS ; col++) /* loop for columns */
+			KEYPAD_debounceKey(key_index, (key_index == pressed_index) ? TRUE : FALSE);
+		}
+	}
+#endif
+
+#ifdef KEYPAD_STATS_ENABLE
+	KEYPAD_STATS_scanDone();
+#endif
+}
+
+/*
+ * Description :
+ * Take the oldest key event from the queue.
+ * Return FALSE if the queue is empty.
+ */
+uint8 KEYPAD_getEvent(KEYPAD_Event_t * event)
+{
+	if(g_keypad_head == g_keypad_tail)
+	{
+		return FALSE;
+	}
+
+	event->key = g_keypad_events[g_keypad_tail].key;
+	event->type = g_keypad_events[g_keypad_tail].type;
+#ifdef KEYPAD_STATS_ENABLE
+	event->time = g_keypad_events[g_keypad_tail].time;
+#endif
+
+	/* the tail is only moved here and the head only in the tick, no locking needed */
+	g_keypad_tail = (g_keypad_tail + 1) % KEYPAD_EVENT_QUEUE_SIZE;
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Return TRUE if no key is held, no event is waiting and no key changed for
+ * KEYPAD_IDLE_TIMEOUT_TICKS scan ticks.
+ */
+uint8 KEYPAD_isInactive(void)
+{
+	uint8 inactive;
+
+	/* the 16-bit counter is updated by the tick, read it in one piece */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		inactive = ((g_keypad_head == g_keypad_tail) && (KEYPAD_IDLE_TIMEOUT_TICKS == g_keypad_quiet_ticks)) ? TRUE : FALSE;
+	}
+
+	return inactive;
+}
+
+/*
+ * Description :
+ * Put the keypad in its idle mode, all the rows driven and the wake-up
+ * interrupt enabled, then sleep in power-down until a key is pressed.
+ * The scan restarts from the first row on wake-up, the pressed key is then
+ * debounced and reported as usual.
+ * Power-down stops the Timer2 LCD tick and the UART clock, while the LCD queue
+ * or the UART Tx buffer still holds data the MCU sleeps in idle mode until the
+ * next tick instead, like the ADC ladder that has no wake-up line.
+ */
+void KEYPAD_sleepUntilKeyPress(void)
+{
+#if (KEYPAD_BACKEND == KEYPAD_MATRIX_BACKEND)
+	uint8 row_bits = KEYPAD_ROWS_MASK;
+
+	/* only the main loop adds to the LCD queue and the UART, both can only drain from here */
+	if(!LCD_isIdle() || !UART_isTxEmpty())
+	{
+		set_sleep_mode(SLEEP_MODE_IDLE);
+		sleep_mode();
+		return;
+	}
+
+	cli();
+	g_keypad_sleeping = TRUE;
+
+	/* drive all the rows so a key in any row reaches the wired-OR column line */
+#if (KEYPAD_BUTTON_PRESSED == LOGIC_LOW)
+	KEYPAD_ROW_PORT &= ~row_bits;
+#else
+	KEYPAD_ROW_PORT |= row_bits;
+#endif
+	KEYPAD_ROW_DDR |= row_bits;
+
+	EXT_INT_setCallBack(KEYPAD_WAKE_INT_ID, KEYPAD_wakeUp);
+	EXT_INT_init(KEYPAD_WAKE_INT_ID, KEYPAD_WAKE_SENSE);
+
+	/* a key already down gives no edge, do not sleep on it */
+#if (KEYPAD_BUTTON_PRESSED == LOGIC_LOW)
+	if((KEYPAD_COL_PIN & KEYPAD_COLS_MASK) != KEYPAD_COLS_MASK)
+#else
+	if(KEYPAD_COL_PIN & KEYPAD_COLS_MASK)
+#endif
+	{
+		KEYPAD_wakeUp();
+		sei();
+		return;
+	}
+
+	/* the instruction after sei always runs, so the wake-up interrupt can not fire before the sleep */
+	set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+	sleep_enable();
+	sei();
+	sleep_cpu();
+	sleep_disable();
+#else
+	/* no wake-up line, the timer tick and the free running ADC keep going in idle mode */
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	sleep_mode();
+#endif
+}
+
+/*
+ * Description :
+ * Wait for the next key press and return the key value, the release events are skipped.
+ * The MCU sleeps while the keypad is inactive.
+ */
+uint8 KEYPAD_getPressedKey(void)
+{
+	KEYPAD_Event_t event;
+
+	do
+	{
+		while(!KEYPAD_getEvent(&event))
+		{
+			/* nothing else runs on the HMI while it waits for a key */
+			if(KEYPAD_isInactive())
 			{
-				/* Check if the switch is pressed in this column */
-				if(GPIO_readPin(KEYPAD_COL_PORT_ID,KEYPAD_FIRST_COL_PIN_ID+col) == KEYPAD_BUTTON_PRESSED)
-				{
-					#if (KEYPAD_NUM_COLS == 3)
-						#ifdef STANDARD_KEYPAD
-							return ((row*KEYPAD_NUM_COLS)+col+1);
-						#else
-							return KEYPAD_4x3_adjustKeyNumber((row*KEYPAD_NUM_COLS)+col+1);
-						#endif
-					#elif (KEYPAD_NUM_COLS == 4)
-						#ifdef STANDARD_KEYPAD
-							return ((row*KEYPAD_NUM_COLS)+col+1);
-						#else
-							return KEYPAD_4x4_adjustKeyNumber((row*KEYPAD_NUM_COLS)+col+1);
-						#endif
-					#endif
-				}
+				KEYPAD_sleepUntilKeyPress();
 			}
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,KEYPAD_FIRST_ROW_PIN_ID+row,PIN_INPUT);
 		}
-	}	
+	}while(event.type != KEYPAD_KEY_PRESSED);
+
+#ifdef KEYPAD_STATS_ENABLE
+	g_stats_last_press = event.time;
+#endif
+
+	return event.key;
 }
 
+#ifdef KEYPAD_STATS_ENABLE
+/*
+ * Description :
+ * Record the echo of the last key returned by KEYPAD_getPressedKey,
+ * to be called once its echo is written to the LCD, see LCD_setWrittenCallBack.
+ */
+void KEYPAD_STATS_markEcho(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		KEYPAD_STATS_addSample(g_stats.echo_delay, (g_stats_ticks - g_stats_last_press) / KEYPAD_STATS_ECHO_BIN_TICKS);
+	}
+}
+
+/*
+ * Description :
+ * Copy the histograms and counters.
+ */
+void KEYPAD_STATS_get(KEYPAD_Stats_t * stats)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		*stats = g_stats;
+	}
+}
+
+/*
+ * Description :
+ * Clear the histograms and counters.
+ */
+void KEYPAD_STATS_reset(void)
+{
+	uint8 i;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		for(i = 0; i < KEYPAD_STATS_NUM_BINS; i++)
+		{
+			g_stats.scan_time[i] = 0;
+			g_stats.press_delay[i] = 0;
+			g_stats.echo_delay[i] = 0;
+		}
+		g_stats.missed = 0;
+		g_stats.duplicates = 0;
+	}
+}
+#endif
+
+static uint8 KEYPAD_getKeyValue(uint8 key_index)
+{
+#ifdef STANDARD_KEYPAD
+	return key_index + 1;
+#elif (KEYPAD_NUM_COLS == 3)
+	return KEYPAD_4x3_adjustKeyNumber(key_index + 1);
+#elif (KEYPAD_NUM_COLS == 4)
+	return KEYPAD_4x4_adjustKeyNumber(key_index + 1);
+#endif
+}
+
+static void KEYPAD_debounceKey(uint8 key_index, uint8 is_pressed)
+{
+	if(is_pressed)
+	{
+#ifdef KEYPAD_STATS_ENABLE
+		if((0 == g_keypad_integrator[key_index]) && !(g_keypad_state & (1u << key_index)))
+		{
+			g_stats_contact[key_index] = g_stats_ticks;
+		}
+#endif
+		if(g_keypad_integrator[key_index] < KEYPAD_DEBOUNCE_SAMPLES)
+		{
+			g_keypad_integrator[key_index]++;
+		}
+	}
+	else if(g_keypad_integrator[key_index] > 0)
+	{
+		g_keypad_integrator[key_index]--;
+	}
+
+	/* the state only changes when the integrator reaches one of its ends */
+	if((KEYPAD_DEBOUNCE_SAMPLES == g_keypad_integrator[key_index]) && !(g_keypad_state & (1u << key_index)))
+	{
+		g_keypad_state |= (1u << key_index);
+		KEYPAD_pushEvent(key_index, KEYPAD_KEY_PRESSED);
+#ifdef KEYPAD_STATS_ENABLE
+		KEYPAD_STATS_addSample(g_stats.press_delay, (g_stats_ticks - g_stats_contact[key_index]) / KEYPAD_STATS_PRESS_BIN_TICKS);
+		if((uint16)(g_stats_ticks - g_stats_release[key_index]) < KEYPAD_STATS_DUPLICATE_TICKS)
+		{
+			/* bounce longer than the debounce time, or a double press nobody can type */
+			g_stats.duplicates++;
+		}
+#endif
+	}
+	else if((0 == g_keypad_integrator[key_index]) && (g_keypad_state & (1u << key_index)))
+	{
+		g_keypad_state &= ~(1u << key_index);
+		KEYPAD_pushEvent(key_index, KEYPAD_KEY_RELEASED);
+#ifdef KEYPAD_STATS_ENABLE
+		g_stats_release[key_index] = g_stats_ticks;
+#endif
+	}
+}
+
+#if (KEYPAD_BACKEND == KEYPAD_MATRIX_BACKEND)
+static void KEYPAD_driveRow(uint8 row)
+{
+	uint8 row_bit = (uint8)(1u << (KEYPAD_FIRST_ROW_PIN_ID + row));
+
+	/* released rows are inputs, only the driven row is an output */
+#if (KEYPAD_BUTTON_PRESSED == LOGIC_LOW)
+	KEYPAD_ROW_PORT &= ~KEYPAD_ROWS_MASK;
+#else
+	KEYPAD_ROW_PORT = (KEYPAD_ROW_PORT & ~KEYPAD_ROWS_MASK) | row_bit;
+#endif
+	KEYPAD_ROW_DDR = (KEYPAD_ROW_DDR & ~KEYPAD_ROWS_MASK) | row_bit;
+}
+
+static void KEYPAD_wakeUp(void)
+{
+	EXT_INT_deInit(KEYPAD_WAKE_INT_ID);
+
+	/* back to the normal scan, the key that woke the MCU is found by the next ticks */
+	g_keypad_row = 0;
+	KEYPAD_driveRow(g_keypad_row);
+	g_keypad_quiet_ticks = 0;
+	g_keypad_sleeping = FALSE;
+}
+#else
+static uint8 KEYPAD_ladderKey(uint16 adc_value)
+{
+	uint8 low = 0;
+	uint8 high = KEYPAD_NUM_KEYS;
+	uint8 mid;
+
+	/* binary search of the first level the reading is below, 4 steps for 16 keys */
+	while(low < high)
+	{
+		mid = (low + high) / 2;
+		if(adc_value < g_keypad_thresholds[mid])
+		{
+			high = mid;
+		}
+		else
+		{
+			low = mid + 1;
+		}
+	}
+
+	return low;
+}
+#endif /* KEYPAD_MATRIX_BACKEND */
+
+static void KEYPAD_pushEvent(uint8 key_index, KEYPAD_EventType type)
+{
+	uint8 next = (g_keypad_head + 1) % KEYPAD_EVENT_QUEUE_SIZE;
+
+	if(next == g_keypad_tail)
+	{
+		/* queue full, the application is not reading the keypad */
+#ifdef KEYPAD_STATS_ENABLE
+		g_stats.missed++;
+#endif
+		return;
+	}
+
+	g_keypad_events[g_keypad_head].key = KEYPAD_getKeyValue(key_index);
+	g_keypad_events[g_keypad_head].type = type;
+#ifdef KEYPAD_STATS_ENABLE
+	g_keypad_events[g_keypad_head].time = g_stats_ticks;
+#endif
+	g_keypad_head = next;
+}
+
+#ifdef KEYPAD_STATS_ENABLE
+static void KEYPAD_STATS_tick(void)
+{
+	g_stats_ticks++;
+}
+
+static void KEYPAD_STATS_scanDone(void)
+{
+	/*
+	 * The tick period is fixed by the timer, only the delay of the scan inside it
+	 * varies: the wait for other interrupts plus the scan itself
+	 */
+	KEYPAD_STATS_addSample(g_stats.scan_time, Timer0_getCounter() / KEYPAD_STATS_SCAN_BIN_COUNTS);
+}
+
+static void KEYPAD_STATS_addSample(uint16 * histogram, uint16 bin)
+{
+	if(bin >= KEYPAD_STATS_NUM_BINS)
+	{
+		bin = KEYPAD_STATS_NUM_BINS - 1;
+	}
+
+	/* saturate instead of wrapping to zero */
+	if(histogram[bin] != 0xFFFF)
+	{
+		histogram[bin]++;
+	}
+}
+#endif
+
 #ifndef STANDARD_KEYPAD
 
 #if (KEYPAD_NUM_COLS == 3)
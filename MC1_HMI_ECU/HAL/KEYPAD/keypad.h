@@ -14,13 +14,28 @@
 #define KEYPAD_H_
 
 #include "../../std_types.h"
+#include "../../MCAL/GPIO/gpio.h"	/* port and pin IDs of the configuration */
+#include "../LCD/lcd.h"				/* pins taken by the LCD transport */
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
 
+/*
+ * Keypad hardware:
+ * KEYPAD_MATRIX_BACKEND     rows and columns on GPIO pins, scanned one row per tick
+ * KEYPAD_ADC_LADDER_BACKEND every key taps a resistor ladder read by one ADC channel,
+ *                           the whole keypad is read by one conversion per tick
+ */
+#define KEYPAD_MATRIX_BACKEND             0
+#define KEYPAD_ADC_LADDER_BACKEND         1
+#define KEYPAD_BACKEND                    KEYPAD_MATRIX_BACKEND
+
 /* Keypad configurations for number of rows and columns */
 #define KEYPAD_NUM_COLS                   4
 #define KEYPAD_NUM_ROWS                   4
+#define KEYPAD_NUM_KEYS                   (KEYPAD_NUM_ROWS * KEYPAD_NUM_COLS)
+
+#if (KEYPAD_BACKEND == KEYPAD_MATRIX_BACKEND)
 
 /* Keypad Port Configurations */
 #define KEYPAD_ROW_PORT_ID                PORTC_ID
@@ -33,14 +48,170 @@
 #define KEYPAD_BUTTON_PRESSED            LOGIC_LOW
 #define KEYPAD_BUTTON_RELEASED           LOGIC_HIGH
 
+/*
+ * Debounce: every key is sampled once per KEYPAD_NUM_ROWS scan ticks, it changes
+ * state after KEYPAD_DEBOUNCE_SAMPLES agreeing samples (16ms with a 1ms tick)
+ */
+#define KEYPAD_DEBOUNCE_SAMPLES          4
+
+/* the LCD backpack is on the TWI pins PC0 (SCL) and PC1 (SDA), the keypad must leave them free */
+#if((LCD_TRANSPORT == LCD_PCF8574_TRANSPORT) && \
+	(((KEYPAD_ROW_PORT_ID == PORTC_ID) && (KEYPAD_FIRST_ROW_PIN_ID <= PIN1_ID)) || \
+	((KEYPAD_COL_PORT_ID == PORTC_ID) && (KEYPAD_FIRST_COL_PIN_ID <= PIN1_ID))))
+
+#error "The keypad uses the TWI pins of the LCD backpack, move it to PORTB which the LCD leaves free"
+
+#endif
+
+#elif (KEYPAD_BACKEND == KEYPAD_ADC_LADDER_BACKEND)
+
+/* Ladder output on ADC0 (PA0), the rest of PORTA stays free */
+#define KEYPAD_ADC_CHANNEL               0
+
+/*
+ * Ladder levels: key n (same numbering as the matrix, row * KEYPAD_NUM_COLS + col)
+ * reads n * KEYPAD_LADDER_STEP, with no key pressed the pull-up reads the ADC
+ * maximum. A key is recognized up to half a step away from its level.
+ */
+#define KEYPAD_LADDER_STEP               60
+#define KEYPAD_LADDER_THRESHOLD(n)       (((n) * KEYPAD_LADDER_STEP) + (KEYPAD_LADDER_STEP / 2))
+
+/*
+ * Debounce: every key is sampled on every scan tick, it changes state after
+ * KEYPAD_DEBOUNCE_SAMPLES agreeing samples (16ms with a 1ms tick)
+ */
+#define KEYPAD_DEBOUNCE_SAMPLES          16
+
+#endif
+
+/* Number of key events kept until the application reads them */
+#define KEYPAD_EVENT_QUEUE_SIZE          16
+
+#if (KEYPAD_BACKEND == KEYPAD_MATRIX_BACKEND)
+/*
+ * Wake-up: the columns are wired-OR (one diode each) to this external interrupt
+ * pin, with all the rows driven any key press pulls it to the pressed level
+ */
+#define KEYPAD_WAKE_INT_ID               EXT_INT2
+#endif
+
+/* Scan ticks without key activity before the keypad is considered inactive (5s with a 1ms tick) */
+#define KEYPAD_IDLE_TIMEOUT_TICKS        5000
+
+/*
+ * Latency instrumentation, for bench builds only: build with -DKEYPAD_STATS_ENABLE.
+ * Times are taken from the scan tick count and the Timer0 count inside the tick.
+ */
+#ifdef KEYPAD_STATS_ENABLE
+#define KEYPAD_STATS_TICK_MS             1      /* scan tick period */
+#define KEYPAD_STATS_NUM_BINS            16     /* bins of every histogram, the last one collects the overflow */
+#define KEYPAD_STATS_SCAN_BIN_COUNTS     1      /* scan time bin width in Timer0 counts (8us) */
+#define KEYPAD_STATS_PRESS_BIN_TICKS     2      /* first contact to press bin width in scan ticks */
+#define KEYPAD_STATS_ECHO_BIN_TICKS      1      /* press to echo bin width in scan ticks */
+#define KEYPAD_STATS_DUPLICATE_TICKS     50     /* a press closer than this to the release of the same key is a duplicate */
+#endif
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef enum
+{
+	KEYPAD_KEY_PRESSED,
+	KEYPAD_KEY_RELEASED
+}KEYPAD_EventType;
+
+typedef struct
+{
+	uint8 key;                /* key value, as returned by KEYPAD_getPressedKey */
+	KEYPAD_EventType type;
+#ifdef KEYPAD_STATS_ENABLE
+	uint16 time;              /* scan tick count when the event was detected */
+#endif
+}KEYPAD_Event_t;
+
+#ifdef KEYPAD_STATS_ENABLE
+typedef struct
+{
+	uint16 scan_time[KEYPAD_STATS_NUM_BINS];     /* tick to the end of its scan: interrupt latency and scan work */
+	uint16 press_delay[KEYPAD_STATS_NUM_BINS];   /* first contact to debounced press */
+	uint16 echo_delay[KEYPAD_STATS_NUM_BINS];    /* debounced press to its echo by the application */
+	uint16 missed;                               /* events dropped because the queue was full */
+	uint16 duplicates;                           /* presses right after a release of the same key */
+}KEYPAD_Stats_t;
+#endif
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
 /*
  * Description :
- * Get the Keypad pressed button
+ * Setup the keypad pins and start the scan from the first row
+ */
+void KEYPAD_init(void);
+
+/*
+ * Description :
+ * Scan the keypad, to be called from a periodic timer tick (1ms).
+ * Matrix: the row driven by the previous call had the whole tick to settle, the
+ * columns are sampled, the keys of the row are debounced and the next row is driven.
+ * ADC ladder: the last free running conversion gives the pressed key, if any.
+ */
+void KEYPAD_scanTask(void);
+
+/*
+ * Description :
+ * Take the oldest key event from the queue.
+ * Return FALSE if the queue is empty.
+ */
+uint8 KEYPAD_getEvent(KEYPAD_Event_t * event);
+
+/*
+ * Description :
+ * Return TRUE if no key is held, no event is waiting and no key changed for
+ * KEYPAD_IDLE_TIMEOUT_TICKS scan ticks.
+ */
+uint8 KEYPAD_isInactive(void);
+
+/*
+ * Description :
+ * Put the keypad in its idle mode, all the rows driven and the wake-up
+ * interrupt enabled, then sleep in power-down until a key is pressed.
+ * The scan restarts from the first row on wake-up, the pressed key is then
+ * debounced and reported as usual.
+ * Power-down stops the Timer2 LCD tick and the UART clock, while the LCD queue
+ * or the UART Tx buffer still holds data the MCU sleeps in idle mode until the
+ * next tick instead, like the ADC ladder that has no wake-up line.
+ */
+void KEYPAD_sleepUntilKeyPress(void);
+
+/*
+ * Description :
+ * Wait for the next key press and return the key value, the release events are skipped.
+ * The MCU sleeps while the keypad is inactive.
  */
 uint8 KEYPAD_getPressedKey(void);
 
+#ifdef KEYPAD_STATS_ENABLE
+/*
+ * Description :
+ * Record the echo of the last key returned by KEYPAD_getPressedKey,
+ * to be called once its echo is written to the LCD, see LCD_setWrittenCallBack.
+ */
+void KEYPAD_STATS_markEcho(void);
+
+/*
+ * Description :
+ * Copy the histograms and counters.
+ */
+void KEYPAD_STATS_get(KEYPAD_Stats_t * stats);
+
+/*
+ * Description :
+ * Clear the histograms and counters.
+ */
+void KEYPAD_STATS_reset(void);
+#endif
+
 #endif /* KEYPAD_H_ */
@@ -13,6 +13,218 @@
 #include <util/delay.h> /* For the delay functions */
 #include "../../common_macros.h" /* For GET_BIT Macro */
 #include "../../MCAL/GPIO/gpio.h"
+#include "../../MCAL/TIMER/timer.h"
+#include <avr/io.h> /* the data bus may be accessed through the port registers */
+#include <util/atomic.h>
+#include <avr/pgmspace.h> /* to read the strings kept in flash */
+#if (LCD_TRANSPORT == LCD_PCF8574_TRANSPORT)
+#include "../../MCAL/TWI/twi.h"
+#endif
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* unchanged cells up to this gap are written again, a cursor move costs one transfer as well */
+#define LCD_FLUSH_MAX_GAP    1
+
+/*
+ * 4-bit bus on contiguous pins in order: a nibble is written with one masked
+ * port register operation, otherwise the pins are written one by one.
+ */
+#if((LCD_TRANSPORT == LCD_GPIO_TRANSPORT) && (LCD_DATA_BITS_MODE == 4) && \
+	(LCD_DB5_PIN_ID == LCD_DB4_PIN_ID + 1) && \
+	(LCD_DB6_PIN_ID == LCD_DB4_PIN_ID + 2) && (LCD_DB7_PIN_ID == LCD_DB4_PIN_ID + 3))
+
+#define LCD_DATA_NIBBLE_WRITE
+#define LCD_DATA_MASK       ((uint8)(0x0F << LCD_DB4_PIN_ID))
+
+#if (LCD_DATA_PORT_ID == PORTA_ID)
+#define LCD_DATA_DDR        DDRA
+#define LCD_DATA_PORT       PORTA
+#elif (LCD_DATA_PORT_ID == PORTB_ID)
+#define LCD_DATA_DDR        DDRB
+#define LCD_DATA_PORT       PORTB
+#elif (LCD_DATA_PORT_ID == PORTC_ID)
+#define LCD_DATA_DDR        DDRC
+#define LCD_DATA_PORT       PORTC
+#elif (LCD_DATA_PORT_ID == PORTD_ID)
+#define LCD_DATA_DDR        DDRD
+#define LCD_DATA_PORT       PORTD
+#endif
+
+#endif
+
+#if(LCD_RW_CONNECTED == 0)
+/* ticks to skip after a transfer so the next one is at least the execution time later */
+#define LCD_SHORT_WAIT_TICKS    (((LCD_SHORT_EXEC_TIME_US + LCD_TICK_US - 1) / LCD_TICK_US) - 1)
+#define LCD_LONG_WAIT_TICKS     (((LCD_LONG_EXEC_TIME_US + LCD_TICK_US - 1) / LCD_TICK_US) - 1)
+#endif
+
+#if (LCD_TRANSPORT == LCD_PCF8574_TRANSPORT)
+/* expander outputs besides the data nibble */
+#define LCD_PCF8574_RS          (1 << LCD_PCF8574_RS_BIT)
+#define LCD_PCF8574_E           (1 << LCD_PCF8574_E_BIT)
+#define LCD_PCF8574_BACKLIGHT   (1 << LCD_PCF8574_BACKLIGHT_BIT)
+
+/* largest transaction: an RS set up byte then an E high and an E low byte per nibble */
+#define LCD_PCF8574_MAX_BYTES   5
+
+/* ticks a transaction may take before the bus is taken as stuck */
+#define LCD_TWI_TIMEOUT_TICKS   ((TWI_TIMEOUT_US + LCD_TICK_US - 1) / LCD_TICK_US)
+#endif
+
+/* data bus pin carrying the busy flag */
+#if(LCD_DATA_BITS_MODE == 4)
+#define LCD_BUSY_FLAG_PIN_ID    LCD_DB7_PIN_ID
+#elif(LCD_DATA_BITS_MODE == 8)
+#define LCD_BUSY_FLAG_PIN_ID    PIN7_ID
+#endif
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* one queued byte, instruction (RS=0) or data (RS=1) */
+typedef struct
+{
+	uint8 value;
+	uint8 rs;
+}LCD_Transfer_t;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* what the application drew, and what the screen shows */
+static uint8 g_lcd_frame[LCD_NUM_ROWS][LCD_NUM_COLS];
+static uint8 g_lcd_shadow[LCD_NUM_ROWS][LCD_NUM_COLS];
+
+/* frame position of the next displayed character */
+static uint8 g_lcd_row = 0;
+static uint8 g_lcd_col = 0;
+
+/* position of the screen cursor, the next data byte is written there */
+static uint8 g_lcd_cursor_row = 0;
+static uint8 g_lcd_cursor_col = 0;
+
+#if(LCD_RW_CONNECTED == 1)
+/* the busy flag can only be read once the interface width is set */
+static uint8 g_lcd_busy_flag_valid = FALSE;
+
+/* ticks the last transfer has been reported busy */
+static uint16 g_lcd_busy_ticks = 0;
+#else
+/* ticks to skip before the next transfer */
+static uint8 g_lcd_wait_ticks = 0;
+#endif
+
+#if (LCD_TRANSPORT == LCD_PCF8574_TRANSPORT)
+/* last byte written to the expander, RS and the backlight stay as set */
+static uint8 g_lcd_expander_output = LCD_PCF8574_BACKLIGHT;
+
+/* transaction to the expander, the bytes not acknowledged yet are sent again */
+static uint8 g_lcd_expander_bytes[LCD_PCF8574_MAX_BYTES];
+static uint8 g_lcd_expander_count = 0;
+static uint8 g_lcd_expander_sent = 0;
+static uint8 g_lcd_expander_attempts = 0;
+
+/* TRUE while the TWI interrupt sends a part of the transaction, for at most LCD_TWI_TIMEOUT_TICKS */
+static uint8 g_lcd_expander_running = FALSE;
+static uint8 g_lcd_expander_ticks = 0;
+#endif
+
+/* output queue, filled by the application and emptied by the Timer2 tick */
+static volatile LCD_Transfer_t g_lcd_queue[LCD_QUEUE_SIZE];
+static volatile uint8 g_lcd_queue_head = 0;
+static volatile uint8 g_lcd_queue_tail = 0;
+
+/* TRUE while Timer2 runs the queue */
+static volatile uint8 g_lcd_queue_running = FALSE;
+
+/* called by the tick once the queue tail reaches g_lcd_written_tail */
+static void (*volatile g_lcd_written_CallBack_ptr)(void) = NULL_PTR;
+static volatile uint8 g_lcd_written_tail;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/*
+ * Function responsible for writing a data byte at the screen cursor
+ */
+static void LCD_sendData(uint8 data);
+
+/*
+ * Function responsible for moving the screen cursor
+ */
+static void LCD_setCursor(uint8 row, uint8 col);
+
+/*
+ * Function responsible for sending an instruction (RS=0) or data (RS=1) byte and waiting for its execution,
+ * used by the initialization before the queue runs
+ */
+static void LCD_write(uint8 value, uint8 rs);
+
+/*
+ * Function responsible for setting RS and latching a byte, without waiting
+ */
+static void LCD_transfer(uint8 value, uint8 rs);
+
+/*
+ * Function responsible for telling clear and return home, the long instructions, from the others
+ */
+static uint8 LCD_isLongInstruction(uint8 value, uint8 rs);
+
+/*
+ * Function responsible for adding a transfer to the queue and starting the tick,
+ * it waits while the queue is full
+ */
+static void LCD_enqueue(uint8 value, uint8 rs);
+
+/*
+ * Timer2 tick: send the next queued transfer once the last one is executed,
+ * stop the tick when the queue is empty
+ */
+static void LCD_serviceQueue(void);
+
+/*
+ * Function responsible for latching one transfer on the data bus, a nibble in 4-bit mode
+ */
+static void LCD_writeBus(uint8 value);
+
+#if (LCD_TRANSPORT == LCD_PCF8574_TRANSPORT)
+/*
+ * Function responsible for starting the write of the given bytes to the expander outputs
+ * in one I2C transaction, the TWI interrupt sends them. Returns at once, LCD_expanderPoll
+ * completes the transaction.
+ */
+static void LCD_expanderWrite(const uint8 *bytes, uint8 count);
+
+/*
+ * Function responsible for completing the expander transaction, called once per tick.
+ * A transaction ended early is sent again from its first byte not acknowledged, the
+ * outputs are levels so a byte sent twice changes nothing. A transfer stuck for
+ * LCD_TWI_TIMEOUT_TICKS frees the bus first. After LCD_PCF8574_MAX_ATTEMPTS the rest
+ * of the transaction is dropped so the queue keeps draining without the backpack.
+ * Returns TRUE once the transaction is over.
+ */
+static uint8 LCD_expanderPoll(void);
+
+/*
+ * Function responsible for completing the expander transaction before the initialization
+ * delays, polling it once per LCD_TICK_US.
+ */
+static void LCD_expanderWait(void);
+#endif
+
+#if(LCD_RW_CONNECTED == 1)
+/*
+ * Function responsible for polling the busy flag up to the given number of reads,
+ * return TRUE if the last instruction is still executing
+ */
+static uint8 LCD_readBusyFlag(uint16 polls);
+#endif
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -23,120 +235,122 @@
  * Initialize the LCD:
  * 1. Setup the LCD pins directions by use the GPIO driver.
  * 2. Setup the LCD Data Mode 4-bits or 8-bits.
+ * The caller lets LCD_POWER_ON_DELAY_MS pass after a power up first, doing its other
+ * initializations meanwhile. The screen clear is queued and runs after it returns.
  */
 void LCD_init(void)
 {
+#if (LCD_TRANSPORT == LCD_PCF8574_TRANSPORT)
+	/* E and RS low with the backlight on, the bus pins are driven by the expander */
+	TWI_init();
+	LCD_expanderWrite(&g_lcd_expander_output, 1);
+	LCD_expanderWait();
+#else
 	/* Configure the direction for RS and E pins as output pins */
 	GPIO_setupPinDirection(LCD_RS_PORT_ID,LCD_RS_PIN_ID,PIN_OUTPUT);
 	GPIO_setupPinDirection(LCD_E_PORT_ID,LCD_E_PIN_ID,PIN_OUTPUT);
+	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW);
+	GPIO_writePin(LCD_RS_PORT_ID,LCD_RS_PIN_ID,LOGIC_LOW); /* Instruction Mode RS=0 */
 
-	_delay_ms(20);		/* LCD Power ON delay always > 15ms */
+#if(LCD_RW_CONNECTED == 1)
+	/* RW is only high while the busy flag is read */
+	GPIO_setupPinDirection(LCD_RW_PORT_ID,LCD_RW_PIN_ID,PIN_OUTPUT);
+	GPIO_writePin(LCD_RW_PORT_ID,LCD_RW_PIN_ID,LOGIC_LOW);
+	g_lcd_busy_flag_valid = FALSE;
+#endif
+#endif /* LCD_TRANSPORT */
 
+	/*
+	 * Initialization by instruction, the interface may be 8 or 4 bits after a reset:
+	 * three 8-bit function sets put it in 8-bit mode, the busy flag can not be read yet
+	 */
 #if(LCD_DATA_BITS_MODE == 4)
+#if (LCD_TRANSPORT == LCD_GPIO_TRANSPORT)
 	/* Configure 4 pins in the data port as output pins */
 	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID,PIN_OUTPUT);
 	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID,PIN_OUTPUT);
 	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID,PIN_OUTPUT);
 	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID,PIN_OUTPUT);
+#endif
+
+	LCD_writeBus(LCD_TWO_LINES_EIGHT_BITS_MODE >> 4);
+	_delay_ms(5);		/* > 4.1ms */
+	LCD_writeBus(LCD_TWO_LINES_EIGHT_BITS_MODE >> 4);
+	_delay_us(150);		/* > 100us */
+	LCD_writeBus(LCD_TWO_LINES_EIGHT_BITS_MODE >> 4);
+	_delay_us(LCD_SHORT_EXEC_TIME_US);
 
-	/* Send for 4 bit initialization of LCD  */
-	LCD_sendCommand(LCD_TWO_LINES_FOUR_BITS_MODE_INIT1);
-	LCD_sendCommand(LCD_TWO_LINES_FOUR_BITS_MODE_INIT2);
+	/* switch to the 4-bit interface, still one transfer */
+	LCD_writeBus(LCD_TWO_LINES_FOUR_BITS_MODE >> 4);
+	_delay_us(LCD_SHORT_EXEC_TIME_US);
 
 	/* use 2-lines LCD + 4-bits Data Mode + 5*7 dot display Mode */
-	LCD_sendCommand(LCD_TWO_LINES_FOUR_BITS_MODE);
+	LCD_write(LCD_TWO_LINES_FOUR_BITS_MODE, LOGIC_LOW);
 
 #elif(LCD_DATA_BITS_MODE == 8)
 	/* Configure the data port as output port */
 	GPIO_setupPortDirection(LCD_DATA_PORT_ID,PORT_OUTPUT);
 
+	LCD_writeBus(LCD_TWO_LINES_EIGHT_BITS_MODE);
+	_delay_ms(5);		/* > 4.1ms */
+	LCD_writeBus(LCD_TWO_LINES_EIGHT_BITS_MODE);
+	_delay_us(150);		/* > 100us */
+	LCD_writeBus(LCD_TWO_LINES_EIGHT_BITS_MODE);
+	_delay_us(LCD_SHORT_EXEC_TIME_US);
+
 	/* use 2-lines LCD + 8-bits Data Mode + 5*7 dot display Mode */
-	LCD_sendCommand(LCD_TWO_LINES_EIGHT_BITS_MODE);
+	LCD_write(LCD_TWO_LINES_EIGHT_BITS_MODE, LOGIC_LOW);
+
+#endif
 
+#if(LCD_RW_CONNECTED == 1)
+	/* the interface is set, the busy flag is valid from now on */
+	g_lcd_busy_flag_valid = TRUE;
 #endif
 
-	LCD_sendCommand(LCD_CURSOR_OFF); /* cursor off */
-	LCD_sendCommand(LCD_CLEAR_COMMAND); /* clear LCD at the beginning */
+	LCD_write(LCD_CURSOR_OFF, LOGIC_LOW); /* cursor off */
+
+	/* from now on every transfer goes through the queue */
+	Timer2_setCallBack(LCD_serviceQueue);
+
+	/* clear LCD at the beginning, the long instruction runs in the background */
+	LCD_sendCommand(LCD_CLEAR_COMMAND);
+
+	/* the screen is blank with its cursor home, start from a blank frame */
+	LCD_clearScreen();
+	for(g_lcd_cursor_row = 0; g_lcd_cursor_row < LCD_NUM_ROWS; g_lcd_cursor_row++)
+	{
+		for(g_lcd_cursor_col = 0; g_lcd_cursor_col < LCD_NUM_COLS; g_lcd_cursor_col++)
+		{
+			g_lcd_shadow[g_lcd_cursor_row][g_lcd_cursor_col] = ' ';
+		}
+	}
+	g_lcd_cursor_row = 0;
+	g_lcd_cursor_col = 0;
 }
 
 /*
  * Description :
- * Send the required command to the screen
+ * Queue the required command to the screen
  */
 void LCD_sendCommand(uint8 command)
 {
-	GPIO_writePin(LCD_RS_PORT_ID,LCD_RS_PIN_ID,LOGIC_LOW); /* Instruction Mode RS=0 */
-	_delay_ms(1); /* delay for processing Tas = 50ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_HIGH); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-
-#if(LCD_DATA_BITS_MODE == 4)
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID,GET_BIT(command,4));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID,GET_BIT(command,5));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID,GET_BIT(command,6));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID,GET_BIT(command,7));
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_HIGH); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID,GET_BIT(command,0));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID,GET_BIT(command,1));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID,GET_BIT(command,2));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID,GET_BIT(command,3));
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-
-#elif(LCD_DATA_BITS_MODE == 8)
-	GPIO_writePort(LCD_DATA_PORT_ID,command); /* out the required command to the data bus D0 --> D7 */
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-#endif
+	LCD_enqueue(command, LOGIC_LOW); /* Instruction Mode RS=0 */
 }
 
 /*
  * Description :
- * Display the required character on the screen
+ * Display the required character on the screen.
+ * The display functions draw in the RAM frame, the screen changes on LCD_flush.
+ * Characters past the last column are dropped.
  */
 void LCD_displayCharacter(uint8 data)
 {
-	GPIO_writePin(LCD_RS_PORT_ID,LCD_RS_PIN_ID,LOGIC_HIGH); /* Data Mode RS=1 */
-	_delay_ms(1); /* delay for processing Tas = 50ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_HIGH); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-
-#if(LCD_DATA_BITS_MODE == 4)
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID,GET_BIT(data,4));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID,GET_BIT(data,5));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID,GET_BIT(data,6));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID,GET_BIT(data,7));
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_HIGH); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID,GET_BIT(data,0));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID,GET_BIT(data,1));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID,GET_BIT(data,2));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID,GET_BIT(data,3));
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-
-#elif(LCD_DATA_BITS_MODE == 8)
-	GPIO_writePort(LCD_DATA_PORT_ID,data); /* out the required command to the data bus D0 --> D7 */
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-#endif
+	if((g_lcd_row < LCD_NUM_ROWS) && (g_lcd_col < LCD_NUM_COLS))
+	{
+		g_lcd_frame[g_lcd_row][g_lcd_col] = data;
+		g_lcd_col++;
+	}
 }
 
 /*
@@ -160,32 +374,29 @@ void LCD_displayString(const char *Str)
 	*********************************************************/
 }
 
+/*
+ * Description :
+ * Display the required string stored in flash (PROGMEM) on the screen
+ */
+void LCD_displayString_P(const char *Str)
+{
+	uint8 character;
+
+	while((character = pgm_read_byte(Str)) != '\0')
+	{
+		LCD_displayCharacter(character);
+		Str++;
+	}
+}
+
 /*
  * Description :
  * Move the cursor to a specified row and column index on the screen
  */
 void LCD_moveCursor(uint8 row,uint8 col)
 {
-	uint8 lcd_memory_address;
-	
-	/* Calculate the required address in the LCD DDRAM */
-	switch(row)
-	{
-		case 0:
-			lcd_memory_address=col;
-				break;
-		case 1:
-			lcd_memory_address=col+0x40;
-				break;
-		case 2:
-			lcd_memory_address=col+0x10;
-				break;
-		case 3:
-			lcd_memory_address=col+0x50;
-				break;
-	}					
-	/* Move the LCD cursor to this specific address */
-	LCD_sendCommand(lcd_memory_address | LCD_SET_CURSOR_LOCATION);
+	g_lcd_row = row;
+	g_lcd_col = col;
 }
 
 /*
@@ -198,22 +409,549 @@ void LCD_displayStringRowColumn(uint8 row,uint8 col,const char *Str)
 	LCD_displayString(Str); /* display the string */
 }
 
+/*
+ * Description :
+ * Display the required string stored in flash (PROGMEM) in a specified row and column index on the screen
+ */
+void LCD_displayStringRowColumn_P(uint8 row,uint8 col,const char *Str)
+{
+	LCD_moveCursor(row,col); /* go to to the required LCD position */
+	LCD_displayString_P(Str); /* display the string */
+}
+
 /*
  * Description :
  * Display the required decimal value on the screen
  */
 void LCD_intgerToString(int data)
 {
-   char buff[16]; /* String to hold the ascii result */
-   itoa(data,buff,10); /* Use itoa C function to convert the data to its corresponding ASCII value, 10 for decimal */
-   LCD_displayString(buff); /* Display the string */
+	if(data < 0)
+	{
+		LCD_displayCharacter('-');
+		/* the magnitude fits the unsigned type even for the most negative value */
+		LCD_displayNumber((uint16)0 - (uint16)data, 0, FORMAT_PAD_SPACE);
+	}
+	else
+	{
+		LCD_displayNumber((uint16)data, 0, FORMAT_PAD_SPACE);
+	}
+}
+
+/*
+ * Description :
+ * Display the required decimal value right-aligned in at least width cells
+ * filled with pad, FORMAT_PAD_ZERO or FORMAT_PAD_SPACE, up to FORMAT_MAX_WIDTH cells.
+ */
+void LCD_displayNumber(uint16 value, uint8 width, char pad)
+{
+	char buff[FORMAT_BUFFER_SIZE]; /* String to hold the ascii result */
+
+	FORMAT_uint16(buff, value, width, pad);
+	LCD_displayString(buff); /* Display the string */
 }
 
 /*
  * Description :
- * Send the clear screen command
+ * Clear the frame and move the cursor to the first cell
  */
 void LCD_clearScreen(void)
 {
-	LCD_sendCommand(LCD_CLEAR_COMMAND); /* Send clear display command */
+	uint8 row, col;
+
+	/* blank cells, the ones already blank on the screen cost nothing on the next flush */
+	for(row = 0; row < LCD_NUM_ROWS; row++)
+	{
+		for(col = 0; col < LCD_NUM_COLS; col++)
+		{
+			g_lcd_frame[row][col] = ' ';
+		}
+	}
+	g_lcd_row = 0;
+	g_lcd_col = 0;
+}
+
+/*
+ * Description :
+ * Queue the frame cells that differ from the screen, the cursor is only moved
+ * to skip unchanged cells. Returns once queued, it only waits if the queue is full.
+ */
+void LCD_flush(void)
+{
+	uint8 row, col;
+
+	for(row = 0; row < LCD_NUM_ROWS; row++)
+	{
+		for(col = 0; col < LCD_NUM_COLS; col++)
+		{
+			if(g_lcd_frame[row][col] == g_lcd_shadow[row][col])
+			{
+				continue;
+			}
+
+			if((row == g_lcd_cursor_row) && (col >= g_lcd_cursor_col) && ((col - g_lcd_cursor_col) <= LCD_FLUSH_MAX_GAP))
+			{
+				/* close enough, write the unchanged cells in between again instead of moving */
+				while(g_lcd_cursor_col < col)
+				{
+					LCD_sendData(g_lcd_frame[row][g_lcd_cursor_col]);
+					g_lcd_cursor_col++;
+				}
+			}
+			else
+			{
+				LCD_setCursor(row, col);
+			}
+
+			LCD_sendData(g_lcd_frame[row][col]);
+			g_lcd_shadow[row][col] = g_lcd_frame[row][col];
+			g_lcd_cursor_col++;	/* the screen moves its cursor to the next cell after a write */
+		}
+	}
+}
+
+/*
+ * Description :
+ * Return TRUE once every queued transfer is executed by the LCD
+ */
+uint8 LCD_isIdle(void)
+{
+	/* the tick stops itself after the last transfer is executed */
+	return g_lcd_queue_running ? FALSE : TRUE;
+}
+
+/*
+ * Description :
+ * Call the function from the LCD tick once every transfer queued so far is written
+ * to the LCD, at once if nothing is left in the queue. Only the last one set is called.
+ */
+void LCD_setWrittenCallBack(void(*a_ptr)(void))
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if(g_lcd_queue_head == g_lcd_queue_tail)
+		{
+			g_lcd_written_CallBack_ptr = NULL_PTR;
+			(*a_ptr)();
+		}
+		else
+		{
+			g_lcd_written_tail = g_lcd_queue_head;
+			g_lcd_written_CallBack_ptr = a_ptr;
+		}
+	}
+}
+
+/*
+ * Description :
+ * Queue the upload of a custom character, pattern holds its LCD_CHARACTER_ROWS
+ * rows from the top with the pixels in the 5 low bits.
+ */
+void LCD_defineCharacter(uint8 location, const uint8 *pattern)
+{
+	uint8 i;
+
+	/* the data bytes go to the CGRAM after its address is set */
+	LCD_sendCommand(LCD_SET_CGRAM_ADDRESS | ((location % LCD_CGRAM_CHARACTERS) * LCD_CHARACTER_ROWS));
+	for(i = 0; i < LCD_CHARACTER_ROWS; i++)
+	{
+		LCD_sendData(pattern[i]);
+	}
+
+	/* the cursor now points in the CGRAM, the next flush has to set it */
+	g_lcd_cursor_row = LCD_NUM_ROWS;
+}
+
+/*
+ * Description :
+ * Upload the custom characters of the progress bar, locations 1 to LCD_BAR_STEPS_PER_CELL
+ */
+void LCD_initProgressBar(void)
+{
+	uint8 pattern[LCD_CHARACTER_ROWS];
+	uint8 columns, i;
+
+	for(columns = 1; columns <= LCD_BAR_STEPS_PER_CELL; columns++)
+	{
+		/* the columns fill from the left, the top and bottom rows are left off to split the cells */
+		pattern[0] = 0;
+		for(i = 1; i < (LCD_CHARACTER_ROWS - 1); i++)
+		{
+			pattern[i] = (uint8)(0x1F << (LCD_BAR_STEPS_PER_CELL - columns)) & 0x1F;
+		}
+		pattern[LCD_CHARACTER_ROWS - 1] = 0;
+
+		LCD_defineCharacter(columns, pattern);
+	}
+}
+
+/*
+ * Description :
+ * Draw a bar of the given cells filled with steps pixel columns, from 0 to
+ * cells * LCD_BAR_STEPS_PER_CELL. One more step only changes one cell.
+ */
+void LCD_displayProgressBar(uint8 row, uint8 col, uint8 cells, uint8 steps)
+{
+	LCD_moveCursor(row, col);
+
+	while(cells--)
+	{
+		if(steps >= LCD_BAR_STEPS_PER_CELL)
+		{
+			LCD_displayCharacter(LCD_BAR_STEPS_PER_CELL);	/* full cell */
+			steps -= LCD_BAR_STEPS_PER_CELL;
+		}
+		else if(steps > 0)
+		{
+			LCD_displayCharacter(steps);	/* the partly filled cell */
+			steps = 0;
+		}
+		else
+		{
+			LCD_displayCharacter(' ');
+		}
+	}
+}
+
+static void LCD_sendData(uint8 data)
+{
+	LCD_enqueue(data, LOGIC_HIGH); /* Data Mode RS=1 */
+}
+
+static void LCD_write(uint8 value, uint8 rs)
+{
+	LCD_transfer(value, rs);
+
+#if (LCD_TRANSPORT == LCD_PCF8574_TRANSPORT)
+	/* the execution time counts from the end of the transaction */
+	LCD_expanderWait();
+#endif
+
+#if(LCD_RW_CONNECTED == 1)
+	if(g_lcd_busy_flag_valid)
+	{
+		LCD_readBusyFlag(LCD_BUSY_TIMEOUT_POLLS);
+		return;
+	}
+#endif
+
+	if(LCD_isLongInstruction(value, rs))
+	{
+		_delay_us(LCD_LONG_EXEC_TIME_US);
+	}
+	else
+	{
+		_delay_us(LCD_SHORT_EXEC_TIME_US);
+	}
+}
+
+static void LCD_transfer(uint8 value, uint8 rs)
+{
+#if (LCD_TRANSPORT == LCD_PCF8574_TRANSPORT)
+	uint8 bytes[5];
+	uint8 count = 0;
+	uint8 control = LCD_PCF8574_BACKLIGHT | (rs ? LCD_PCF8574_RS : 0);
+
+	/* a changed RS is set up with E low first (Tas = 40ns) */
+	if((g_lcd_expander_output & LCD_PCF8574_RS) != (control & LCD_PCF8574_RS))
+	{
+		bytes[count++] = (g_lcd_expander_output & (0x0F << LCD_PCF8574_DB4_BIT)) | control;
+	}
+
+	/* both nibbles in one transaction, each latched by an E high then E low byte */
+	bytes[count++] = ((value >> 4) << LCD_PCF8574_DB4_BIT) | control | LCD_PCF8574_E;
+	bytes[count++] = ((value >> 4) << LCD_PCF8574_DB4_BIT) | control;
+	bytes[count++] = ((value & 0x0F) << LCD_PCF8574_DB4_BIT) | control | LCD_PCF8574_E;
+	bytes[count++] = ((value & 0x0F) << LCD_PCF8574_DB4_BIT) | control;
+
+	LCD_expanderWrite(bytes, count);
+#else
+	GPIO_writePin(LCD_RS_PORT_ID,LCD_RS_PIN_ID,rs);
+
+#if(LCD_DATA_BITS_MODE == 4)
+	LCD_writeBus(value >> 4);	/* high nibble first */
+	LCD_writeBus(value & 0x0F);
+#elif(LCD_DATA_BITS_MODE == 8)
+	LCD_writeBus(value);
+#endif
+#endif /* LCD_TRANSPORT */
+}
+
+static uint8 LCD_isLongInstruction(uint8 value, uint8 rs)
+{
+	/* clear and return home are the only long instructions */
+	return ((LOGIC_LOW == rs) && ((LCD_CLEAR_COMMAND == value) || (LCD_GO_TO_HOME == (value & 0xFE)))) ? TRUE : FALSE;
+}
+
+static void LCD_enqueue(uint8 value, uint8 rs)
+{
+	/* 8MHz / 8 gives 1us counts, a compare match every LCD_TICK_US */
+	Timer2_Config_t tick_config = {0, LCD_TICK_US - 1, TIMER2_PRESCALER_8, TIMER2_CTC_MODE};
+	uint8 next = (g_lcd_queue_head + 1) % LCD_QUEUE_SIZE;
+
+	/* queue full, the tick frees one entry at a time */
+	while(next == g_lcd_queue_tail);
+
+	g_lcd_queue[g_lcd_queue_head].value = value;
+	g_lcd_queue[g_lcd_queue_head].rs = rs;
+	g_lcd_queue_head = next;
+
+	/* the tick may stop between the check and the start, decide with the interrupts off */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if(!g_lcd_queue_running)
+		{
+			g_lcd_queue_running = TRUE;
+			Timer2_init(&tick_config);
+		}
+	}
+}
+
+static void LCD_serviceQueue(void)
+{
+	uint8 tail = g_lcd_queue_tail;
+
+#if (LCD_TRANSPORT == LCD_PCF8574_TRANSPORT)
+	/* the TWI interrupt is still sending the last transaction, the tick only dequeues */
+	if(!LCD_expanderPoll())
+	{
+		return;
+	}
+#endif
+
+#if(LCD_RW_CONNECTED == 1)
+	/* the last transfer is still executing, give up waiting on a stuck display */
+	if(LCD_readBusyFlag(1) && (++g_lcd_busy_ticks < LCD_BUSY_TIMEOUT_POLLS))
+	{
+		return;
+	}
+	g_lcd_busy_ticks = 0;
+#else
+	if(g_lcd_wait_ticks)
+	{
+		g_lcd_wait_ticks--;
+		return;
+	}
+#endif
+
+	if(g_lcd_queue_head == tail)
+	{
+		/* everything is on the screen, no tick until the next transfer is queued */
+		Timer2_deInit();
+		g_lcd_queue_running = FALSE;
+		return;
+	}
+
+	LCD_transfer(g_lcd_queue[tail].value, g_lcd_queue[tail].rs);
+
+#if(LCD_RW_CONNECTED == 0)
+	g_lcd_wait_ticks = LCD_isLongInstruction(g_lcd_queue[tail].value, g_lcd_queue[tail].rs) ?
+			LCD_LONG_WAIT_TICKS : LCD_SHORT_WAIT_TICKS;
+#endif
+
+	/* the tail is only moved here and the head only by the application, no locking needed */
+	g_lcd_queue_tail = (tail + 1) % LCD_QUEUE_SIZE;
+
+	if(g_lcd_written_CallBack_ptr && (g_lcd_queue_tail == g_lcd_written_tail))
+	{
+		(*g_lcd_written_CallBack_ptr)();
+		g_lcd_written_CallBack_ptr = NULL_PTR;
+	}
+}
+
+static void LCD_writeBus(uint8 value)
+{
+#if (LCD_TRANSPORT == LCD_PCF8574_TRANSPORT)
+	uint8 bytes[2];
+	uint8 control = g_lcd_expander_output & (LCD_PCF8574_RS | LCD_PCF8574_BACKLIGHT);
+
+	/* E high then E low in one transaction, each byte lasts 22.5us on the 400kHz bus (Tpw = 230ns) */
+	bytes[0] = (value << LCD_PCF8574_DB4_BIT) | control | LCD_PCF8574_E;
+	bytes[1] = (value << LCD_PCF8574_DB4_BIT) | control;
+	LCD_expanderWrite(bytes, 2);
+
+	/* only used by the initialization, its delays count from the end of the transaction */
+	LCD_expanderWait();
+#else
+#if defined(LCD_DATA_NIBBLE_WRITE)
+	LCD_DATA_PORT = (LCD_DATA_PORT & ~LCD_DATA_MASK) | ((value << LCD_DB4_PIN_ID) & LCD_DATA_MASK);
+#elif(LCD_DATA_BITS_MODE == 4)
+	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID,GET_BIT(value,0));
+	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID,GET_BIT(value,1));
+	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID,GET_BIT(value,2));
+	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID,GET_BIT(value,3));
+#elif(LCD_DATA_BITS_MODE == 8)
+	GPIO_writePort(LCD_DATA_PORT_ID,value); /* out the required value to the data bus D0 --> D7 */
+#endif
+
+	/* RS and the data were set up long before (Tas = 40ns, Tdsw = 80ns) */
+	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_HIGH); /* Enable LCD E=1 */
+	_delay_us(1); /* Tpw = 230ns */
+	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0, data latched */
+	_delay_us(1); /* Tcycle = 500ns, Th = 10ns */
+#endif /* LCD_TRANSPORT */
+}
+
+#if (LCD_TRANSPORT == LCD_PCF8574_TRANSPORT)
+static void LCD_expanderWrite(const uint8 *bytes, uint8 count)
+{
+	uint8 i;
+
+	/* the previous transaction is always over by now */
+	for(i = 0; i < count; i++)
+	{
+		g_lcd_expander_bytes[i] = bytes[i];
+	}
+	g_lcd_expander_count = count;
+	g_lcd_expander_sent = 0;
+	g_lcd_expander_attempts = 0;
+	g_lcd_expander_ticks = 0;
+
+	g_lcd_expander_output = bytes[count - 1];
+
+	/* start it at once, the later ticks only check on it */
+	LCD_expanderPoll();
+}
+
+static uint8 LCD_expanderPoll(void)
+{
+	if(g_lcd_expander_running)
+	{
+		if(TWI_isBusy())
+		{
+			if(++g_lcd_expander_ticks < LCD_TWI_TIMEOUT_TICKS)
+			{
+				return FALSE;
+			}
+
+			/* TWINT never came, free the bus, about 0.1ms of a rare fault */
+			TWI_recoverBus();
+		}
+
+		g_lcd_expander_sent += TWI_getAsyncSent();
+		g_lcd_expander_running = FALSE;
+	}
+
+	if(g_lcd_expander_sent >= g_lcd_expander_count)
+	{
+		return TRUE;
+	}
+
+	if(g_lcd_expander_attempts >= LCD_PCF8574_MAX_ATTEMPTS)
+	{
+		/* no backpack answers, give up on the rest so the queue does not stall */
+		g_lcd_expander_sent = g_lcd_expander_count;
+		return TRUE;
+	}
+
+	/* first attempt, or a NACK, lost arbitration or bus error ended the last one early */
+	if(TWI_writeAsync(LCD_PCF8574_ADDRESS, &g_lcd_expander_bytes[g_lcd_expander_sent],
+			g_lcd_expander_count - g_lcd_expander_sent))
+	{
+		g_lcd_expander_running = TRUE;
+		g_lcd_expander_ticks = 0;
+		g_lcd_expander_attempts++;
+	}
+	else if(++g_lcd_expander_ticks >= LCD_TWI_TIMEOUT_TICKS)
+	{
+		/* the stop condition of the last transfer never ended */
+		TWI_recoverBus();
+		g_lcd_expander_ticks = 0;
+	}
+
+	return FALSE;
+}
+
+static void LCD_expanderWait(void)
+{
+	while(!LCD_expanderPoll())
+	{
+		_delay_us(LCD_TICK_US);
+	}
+}
+#endif
+
+#if(LCD_RW_CONNECTED == 1)
+static uint8 LCD_readBusyFlag(uint16 polls)
+{
+	uint8 busy;
+
+	/* release the data bus to the LCD, no pull-ups, then read the instruction register */
+#if defined(LCD_DATA_NIBBLE_WRITE)
+	LCD_DATA_DDR &= ~LCD_DATA_MASK;
+	LCD_DATA_PORT &= ~LCD_DATA_MASK;
+#elif(LCD_DATA_BITS_MODE == 4)
+	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID,PIN_INPUT);
+	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID,PIN_INPUT);
+	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID,PIN_INPUT);
+	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID,PIN_INPUT);
+	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID,LOGIC_LOW);
+	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID,LOGIC_LOW);
+	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID,LOGIC_LOW);
+	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID,LOGIC_LOW);
+#elif(LCD_DATA_BITS_MODE == 8)
+	GPIO_setupPortDirection(LCD_DATA_PORT_ID,PORT_INPUT);
+	GPIO_writePort(LCD_DATA_PORT_ID,0);
+#endif
+	GPIO_writePin(LCD_RS_PORT_ID,LCD_RS_PIN_ID,LOGIC_LOW);
+	GPIO_writePin(LCD_RW_PORT_ID,LCD_RW_PIN_ID,LOGIC_HIGH);
+
+	do
+	{
+		GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_HIGH);
+		_delay_us(1); /* Tddr = 160ns */
+		busy = GPIO_readPin(LCD_DATA_PORT_ID,LCD_BUSY_FLAG_PIN_ID);
+		GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW);
+		_delay_us(1);
+
+#if(LCD_DATA_BITS_MODE == 4)
+		/* the low nibble holds the address counter, clock it out unread */
+		GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_HIGH);
+		_delay_us(1);
+		GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW);
+		_delay_us(1);
+#endif
+	}while(busy && --polls);
+
+	/* back to writing */
+	GPIO_writePin(LCD_RW_PORT_ID,LCD_RW_PIN_ID,LOGIC_LOW);
+#if defined(LCD_DATA_NIBBLE_WRITE)
+	LCD_DATA_DDR |= LCD_DATA_MASK;
+#elif(LCD_DATA_BITS_MODE == 4)
+	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID,PIN_OUTPUT);
+	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID,PIN_OUTPUT);
+	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID,PIN_OUTPUT);
+	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID,PIN_OUTPUT);
+#elif(LCD_DATA_BITS_MODE == 8)
+	GPIO_setupPortDirection(LCD_DATA_PORT_ID,PORT_OUTPUT);
+#endif
+
+	return busy;
+}
+#endif
+
+static void LCD_setCursor(uint8 row, uint8 col)
+{
+	uint8 lcd_memory_address;
+	
+	/* Calculate the required address in the LCD DDRAM */
+	switch(row)
+	{
+		case 0:
+			lcd_memory_address=col;
+				break;
+		case 1:
+			lcd_memory_address=col+0x40;
+				break;
+		case 2:
+			lcd_memory_address=col+0x10;
+				break;
+		case 3:
+			lcd_memory_address=col+0x50;
+				break;
+	}					
+	/* Move the LCD cursor to this specific address */
+	LCD_sendCommand(lcd_memory_address | LCD_SET_CURSOR_LOCATION);
+
+	g_lcd_cursor_row = row;
+	g_lcd_cursor_col = col;
 }
@@ -14,11 +14,21 @@
 #define LCD_H_
 
 #include "../../std_types.h"
+#include "../../LIB/FORMAT/format.h"
 
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
 
+/*
+ * LCD transport configuration:
+ * LCD_GPIO_TRANSPORT    RS, E, RW and the data bus on the GPIO pins below
+ * LCD_PCF8574_TRANSPORT PCF8574 I2C backpack on the TWI pins, 4-bit bus with RW tied low
+ */
+#define LCD_GPIO_TRANSPORT             0
+#define LCD_PCF8574_TRANSPORT          1
+#define LCD_TRANSPORT                  LCD_GPIO_TRANSPORT
+
 /* LCD Data bits mode configuration, its value should be 4 or 8*/
 #define LCD_DATA_BITS_MODE 4
 
@@ -28,6 +38,36 @@
 
 #endif
 
+#if((LCD_TRANSPORT == LCD_PCF8574_TRANSPORT) && (LCD_DATA_BITS_MODE != 4))
+
+#error "The PCF8574 backpack only wires the 4-bits data bus"
+
+#endif
+
+/* LCD size, the application draws in a RAM frame of this size */
+#define LCD_NUM_ROWS                   2
+#define LCD_NUM_COLS                   16
+
+#if (LCD_TRANSPORT == LCD_PCF8574_TRANSPORT)
+
+/* Backpack slave address: 0x27 for a PCF8574 with A0..A2 open, 0x3F for a PCF8574A */
+#define LCD_PCF8574_ADDRESS            0x27
+
+/* Transactions started for one transfer before its bytes not acknowledged are dropped */
+#define LCD_PCF8574_MAX_ATTEMPTS       3
+
+/* Backpack wiring of the expander pins P0..P7, DB4..DB7 are on P4..P7 */
+#define LCD_PCF8574_RS_BIT             0
+#define LCD_PCF8574_RW_BIT             1
+#define LCD_PCF8574_E_BIT              2
+#define LCD_PCF8574_BACKLIGHT_BIT      3
+#define LCD_PCF8574_DB4_BIT            4
+
+/* RW is only driven low, a busy flag read would cost a bus transaction per poll */
+#define LCD_RW_CONNECTED               0
+
+#else
+
 /* LCD HW Ports and Pins Ids */
 #define LCD_RS_PORT_ID                 PORTB_ID
 #define LCD_RS_PIN_ID                  PIN0_ID
@@ -35,6 +75,22 @@
 #define LCD_E_PORT_ID                  PORTB_ID
 #define LCD_E_PIN_ID                   PIN1_ID
 
+/*
+ * LCD RW pin configuration:
+ * 1: RW is wired to LCD_RW_PIN_ID, the driver waits on the busy flag
+ * 0: RW is tied low, the driver waits the worst case execution times
+ */
+#define LCD_RW_CONNECTED               1
+
+#if((LCD_RW_CONNECTED != 0) && (LCD_RW_CONNECTED != 1))
+
+#error "LCD_RW_CONNECTED should be equal to 0 or 1"
+
+#endif
+
+#define LCD_RW_PORT_ID                 PORTB_ID
+#define LCD_RW_PIN_ID                  PIN7_ID
+
 #define LCD_DATA_PORT_ID               PORTB_ID
 
 #if (LCD_DATA_BITS_MODE == 4)
@@ -46,16 +102,53 @@
 
 #endif
 
+#endif /* LCD_TRANSPORT */
+
 /* LCD Commands */
 #define LCD_CLEAR_COMMAND                    0x01
 #define LCD_GO_TO_HOME                       0x02
 #define LCD_TWO_LINES_EIGHT_BITS_MODE        0x38
 #define LCD_TWO_LINES_FOUR_BITS_MODE         0x28
-#define LCD_TWO_LINES_FOUR_BITS_MODE_INIT1   0x33
-#define LCD_TWO_LINES_FOUR_BITS_MODE_INIT2   0x32
 #define LCD_CURSOR_OFF                       0x0C
 #define LCD_CURSOR_ON                        0x0E
 #define LCD_SET_CURSOR_LOCATION              0x80
+#define LCD_SET_CGRAM_ADDRESS                0x40
+
+/* Custom characters, shown by writing their location 0..7 as the character code */
+#define LCD_CGRAM_CHARACTERS                 8
+#define LCD_CHARACTER_ROWS                   8
+
+/*
+ * Progress bar: a cell fills one pixel column per step, the character of a cell
+ * with n filled columns is the custom character at location n.
+ */
+#define LCD_BAR_STEPS_PER_CELL               5
+
+/* Wait after the LCD supply reaches 4.5V before it accepts instructions */
+#define LCD_POWER_ON_DELAY_MS                15
+
+/*
+ * Execution times of the HD44780 at its slowest oscillator (190kHz instead of 270kHz),
+ * used when the busy flag can not be read: before the interface is set and with RW tied low
+ */
+#define LCD_SHORT_EXEC_TIME_US               53
+#define LCD_LONG_EXEC_TIME_US                2200     /* clear and return home */
+
+/* Busy flag reads before the driver gives up on a missing or stuck display */
+#define LCD_BUSY_TIMEOUT_POLLS               1000
+
+/*
+ * Output queue: the transfers are sent by the Timer2 interrupt, one byte per tick.
+ * Timer2 only runs while the queue is not empty. With the backpack the tick only
+ * starts the I2C transaction, the TWI interrupt sends its bytes. A transaction
+ * that ends early is sent again from the next tick, a stuck bus is recovered.
+ */
+#define LCD_QUEUE_SIZE                       48
+#if (LCD_TRANSPORT == LCD_PCF8574_TRANSPORT)
+#define LCD_TICK_US                          160      /* longer than one transaction of up to 5 bytes on the 400kHz bus */
+#else
+#define LCD_TICK_US                          50
+#endif
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
@@ -66,18 +159,22 @@
  * Initialize the LCD:
  * 1. Setup the LCD pins directions by use the GPIO driver.
  * 2. Setup the LCD Data Mode 4-bits or 8-bits.
+ * The caller lets LCD_POWER_ON_DELAY_MS pass after a power up first, doing its other
+ * initializations meanwhile. The screen clear is queued and runs after it returns.
  */
 void LCD_init(void);
 
 /*
  * Description :
- * Send the required command to the screen
+ * Queue the required command to the screen
  */
 void LCD_sendCommand(uint8 command);
 
 /*
  * Description :
- * Display the required character on the screen
+ * Display the required character on the screen.
+ * The display functions draw in the RAM frame, the screen changes on LCD_flush.
+ * Characters past the last column are dropped.
  */
 void LCD_displayCharacter(uint8 data);
 
@@ -87,6 +184,12 @@ void LCD_displayCharacter(uint8 data);
  */
 void LCD_displayString(const char *Str);
 
+/*
+ * Description :
+ * Display the required string stored in flash (PROGMEM) on the screen
+ */
+void LCD_displayString_P(const char *Str);
+
 /*
  * Description :
  * Move the cursor to a specified row and column index on the screen
@@ -99,6 +202,12 @@ void LCD_moveCursor(uint8 row,uint8 col);
  */
 void LCD_displayStringRowColumn(uint8 row,uint8 col,const char *Str);
 
+/*
+ * Description :
+ * Display the required string stored in flash (PROGMEM) in a specified row and column index on the screen
+ */
+void LCD_displayStringRowColumn_P(uint8 row,uint8 col,const char *Str);
+
 /*
  * Description :
  * Display the required decimal value on the screen
@@ -107,8 +216,55 @@ void LCD_intgerToString(int data);
 
 /*
  * Description :
- * Send the clear screen command
+ * Display the required decimal value right-aligned in at least width cells
+ * filled with pad, FORMAT_PAD_ZERO or FORMAT_PAD_SPACE, up to FORMAT_MAX_WIDTH cells.
+ */
+void LCD_displayNumber(uint16 value, uint8 width, char pad);
+
+/*
+ * Description :
+ * Clear the frame and move the cursor to the first cell
  */
 void LCD_clearScreen(void);
 
+/*
+ * Description :
+ * Queue the frame cells that differ from the screen, the cursor is only moved
+ * to skip unchanged cells. Returns once queued, it only waits if the queue is full.
+ */
+void LCD_flush(void);
+
+/*
+ * Description :
+ * Return TRUE once every queued transfer is executed by the LCD
+ */
+uint8 LCD_isIdle(void);
+
+/*
+ * Description :
+ * Call the function from the LCD tick once every transfer queued so far is written
+ * to the LCD, at once if nothing is left in the queue. Only the last one set is called.
+ */
+void LCD_setWrittenCallBack(void(*a_ptr)(void));
+
+/*
+ * Description :
+ * Queue the upload of a custom character, pattern holds its LCD_CHARACTER_ROWS
+ * rows from the top with the pixels in the 5 low bits.
+ */
+void LCD_defineCharacter(uint8 location, const uint8 *pattern);
+
+/*
+ * Description :
+ * Upload the custom characters of the progress bar, locations 1 to LCD_BAR_STEPS_PER_CELL
+ */
+void LCD_initProgressBar(void);
+
+/*
+ * Description :
+ * Draw a bar of the given cells filled with steps pixel columns, from 0 to
+ * cells * LCD_BAR_STEPS_PER_CELL. One more step only changes one cell.
+ */
+void LCD_displayProgressBar(uint8 row, uint8 col, uint8 cells, uint8 steps);
+
 #endif /* LCD_H_ */
@@ -0,0 +1,168 @@
+/******************************************************************************
+ *
+ * Module: FORMAT
+ *
+ * File Name: format.c
+ *
+ * Description: Source file for the decimal formatting library
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+#include "format.h"
+#include <avr/pgmspace.h>	/* the powers of ten tables are kept in flash */
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/*
+ * Every digit is found by subtracting its power of ten, at most 9 times, the AVR
+ * has no divide instruction and the library division is far slower.
+ */
+static const uint32 g_format_pow10_32[] PROGMEM =
+{
+	1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL, 10000UL, 1000UL, 100UL, 10UL
+};
+
+static const uint16 g_format_pow10_16[] PROGMEM =
+{
+	10000u, 1000u, 100u, 10u
+};
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/*
+ * Function responsible for moving the digits right to the width, filling the front with pad
+ */
+static uint8 FORMAT_align(char * buffer, uint8 length, uint8 width, char pad);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Write the decimal value in the buffer followed by a null, right-aligned in at
+ * least width characters filled with pad. A longer value is never cut.
+ * Return the number of characters written, without the null.
+ */
+uint8 FORMAT_uint8(char * buffer, uint8 value, uint8 width, char pad)
+{
+	uint8 length = 0;
+	char digit;
+
+	/* hundreds and tens, leading zeros are skipped */
+	for(digit = '0'; value >= 100; value -= 100)
+	{
+		digit++;
+	}
+	if(digit != '0')
+	{
+		buffer[length++] = digit;
+	}
+
+	for(digit = '0'; value >= 10; value -= 10)
+	{
+		digit++;
+	}
+	if((digit != '0') || (length > 0))
+	{
+		buffer[length++] = digit;
+	}
+
+	buffer[length++] = '0' + value;
+
+	return FORMAT_align(buffer, length, width, pad);
+}
+
+uint8 FORMAT_uint16(char * buffer, uint16 value, uint8 width, char pad)
+{
+	uint8 length = 0;
+	uint8 i;
+	uint16 power;
+	char digit;
+
+	for(i = 0; i < sizeof(g_format_pow10_16) / sizeof(g_format_pow10_16[0]); i++)
+	{
+		power = pgm_read_word(&g_format_pow10_16[i]);
+		for(digit = '0'; value >= power; value -= power)
+		{
+			digit++;
+		}
+
+		/* leading zeros are skipped */
+		if((digit != '0') || (length > 0))
+		{
+			buffer[length++] = digit;
+		}
+	}
+
+	buffer[length++] = '0' + (uint8)value;
+
+	return FORMAT_align(buffer, length, width, pad);
+}
+
+uint8 FORMAT_uint32(char * buffer, uint32 value, uint8 width, char pad)
+{
+	uint8 length = 0;
+	uint8 i;
+	uint32 power;
+	char digit;
+
+	/* the 16-bit path is much cheaper on the 8-bit core */
+	if(value <= 0xFFFF)
+	{
+		return FORMAT_uint16(buffer, (uint16)value, width, pad);
+	}
+
+	for(i = 0; i < sizeof(g_format_pow10_32) / sizeof(g_format_pow10_32[0]); i++)
+	{
+		power = pgm_read_dword(&g_format_pow10_32[i]);
+		for(digit = '0'; value >= power; value -= power)
+		{
+			digit++;
+		}
+
+		/* leading zeros are skipped */
+		if((digit != '0') || (length > 0))
+		{
+			buffer[length++] = digit;
+		}
+	}
+
+	buffer[length++] = '0' + (uint8)value;
+
+	return FORMAT_align(buffer, length, width, pad);
+}
+
+static uint8 FORMAT_align(char * buffer, uint8 length, uint8 width, char pad)
+{
+	uint8 i;
+
+	/* the field and its null must fit the caller's FORMAT_BUFFER_SIZE buffer */
+	if(width > FORMAT_MAX_WIDTH)
+	{
+		width = FORMAT_MAX_WIDTH;
+	}
+
+	if(width > length)
+	{
+		/* shift the digits to the end of the field, from the last one */
+		for(i = length; i > 0; i--)
+		{
+			buffer[(width - length) + (i - 1)] = buffer[i - 1];
+		}
+		for(i = 0; i < (width - length); i++)
+		{
+			buffer[i] = pad;
+		}
+		length = width;
+	}
+
+	buffer[length] = '\0';
+
+	return length;
+}
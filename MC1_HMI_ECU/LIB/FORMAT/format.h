@@ -0,0 +1,47 @@
+/******************************************************************************
+ *
+ * Module: FORMAT
+ *
+ * File Name: format.h
+ *
+ * Description: Header file for the decimal formatting library
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#ifndef LIB_FORMAT_FORMAT_H_
+#define LIB_FORMAT_FORMAT_H_
+
+#include "../../std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Buffer size holding any formatted value: 10 digits of a 32-bit value and the null */
+#define FORMAT_BUFFER_SIZE       11
+
+/* Widest field, a larger width is reduced to it so the buffer is never overrun */
+#define FORMAT_MAX_WIDTH         (FORMAT_BUFFER_SIZE - 1)
+
+/* Padding characters */
+#define FORMAT_PAD_ZERO          '0'     /* zero-padded */
+#define FORMAT_PAD_SPACE         ' '     /* right-aligned */
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Write the decimal value in the buffer followed by a null, right-aligned in at
+ * least width characters filled with pad. A longer value is never cut, width is
+ * limited to FORMAT_MAX_WIDTH. The buffer holds FORMAT_BUFFER_SIZE characters.
+ * Return the number of characters written, without the null.
+ */
+uint8 FORMAT_uint8(char * buffer, uint8 value, uint8 width, char pad);
+uint8 FORMAT_uint16(char * buffer, uint16 value, uint8 width, char pad);
+uint8 FORMAT_uint32(char * buffer, uint32 value, uint8 width, char pad);
+
+#endif /* LIB_FORMAT_FORMAT_H_ */
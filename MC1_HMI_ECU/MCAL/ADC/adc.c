@@ -0,0 +1,77 @@
+ /******************************************************************************
+ *
+ * Module: ADC
+ *
+ * File Name: adc.c
+ *
+ * Description: Source file for the ATmega32 ADC driver
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+#include "adc.h"
+#include "../../common_macros.h"
+#include <avr/io.h>		/* to use the ADC registers */
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define ADC_CHANNEL_MASK    0x07
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Select the reference voltage and the clock prescaler, then enable the ADC
+ */
+void ADC_init(const ADC_Config_t * config)
+{
+	/* right adjusted result, channel 0 until a channel is selected */
+	ADMUX = (config->ref_volt << REFS0);
+
+	/* enable the ADC without its interrupt, the results are polled */
+	ADCSRA = (1<<ADEN) | (config->prescaler << ADPS0);
+}
+
+/*
+ * Description :
+ * Start a single conversion on the channel and wait for its result
+ */
+uint16 ADC_readChannel(uint8 channel_num)
+{
+	ADMUX = (ADMUX & ~ADC_CHANNEL_MASK) | (channel_num & ADC_CHANNEL_MASK);
+	SET_BIT(ADCSRA, ADSC);
+
+	/* ADIF is set at the end of the conversion, it is cleared by writing one */
+	while(BIT_IS_CLEAR(ADCSRA, ADIF));
+	SET_BIT(ADCSRA, ADIF);
+
+	return ADC;
+}
+
+/*
+ * Description :
+ * Convert the channel continuously in free running mode, a new result is
+ * ready every 13 ADC clocks without any further action.
+ */
+void ADC_startFreeRunning(uint8 channel_num)
+{
+	ADMUX = (ADMUX & ~ADC_CHANNEL_MASK) | (channel_num & ADC_CHANNEL_MASK);
+
+	/* ADTS2:0 = 000 is the free running trigger, the first conversion is started by hand */
+	SFIOR &= ~((1<<ADTS2) | (1<<ADTS1) | (1<<ADTS0));
+	ADCSRA |= (1<<ADATE) | (1<<ADSC);
+}
+
+/*
+ * Description :
+ * Return the result of the last completed conversion
+ */
+uint16 ADC_getResult(void)
+{
+	/* the compiler reads ADCL before ADCH, which locks the pair until ADCH is read */
+	return ADC;
+}
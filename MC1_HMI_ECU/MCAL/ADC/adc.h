@@ -0,0 +1,83 @@
+ /******************************************************************************
+ *
+ * Module: ADC
+ *
+ * File Name: adc.h
+ *
+ * Description: Header file for the ATmega32 ADC driver
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#ifndef MCAL_ADC_ADC_H_
+#define MCAL_ADC_ADC_H_
+
+#include "../../std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define ADC_MAXIMUM_VALUE    1023
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* REFS1:REFS0 values */
+typedef enum
+{
+	ADC_AREF,
+	ADC_AVCC,
+	ADC_INTERNAL_2_56V = 3
+}ADC_ReferenceVoltage;
+
+/* ADPS2:ADPS0 values, the ADC clock must be 50kHz - 200kHz for the full resolution */
+typedef enum
+{
+	ADC_F_CPU_2 = 1,
+	ADC_F_CPU_4,
+	ADC_F_CPU_8,
+	ADC_F_CPU_16,
+	ADC_F_CPU_32,
+	ADC_F_CPU_64,
+	ADC_F_CPU_128
+}ADC_Prescaler;
+
+typedef struct
+{
+	ADC_ReferenceVoltage ref_volt;
+	ADC_Prescaler prescaler;
+}ADC_Config_t;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Select the reference voltage and the clock prescaler, then enable the ADC
+ */
+void ADC_init(const ADC_Config_t * config);
+
+/*
+ * Description :
+ * Start a single conversion on the channel and wait for its result
+ */
+uint16 ADC_readChannel(uint8 channel_num);
+
+/*
+ * Description :
+ * Convert the channel continuously in free running mode, a new result is
+ * ready every 13 ADC clocks without any further action.
+ */
+void ADC_startFreeRunning(uint8 channel_num);
+
+/*
+ * Description :
+ * Return the result of the last completed conversion
+ */
+uint16 ADC_getResult(void);
+
+#endif /* MCAL_ADC_ADC_H_ */
@@ -0,0 +1,134 @@
+ /******************************************************************************
+ *
+ * Module: EXT_INT
+ *
+ * File Name: ext_int.c
+ *
+ * Description: Source file for the ATmega32 External Interrupts driver
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+#include "ext_int.h"
+#include "../../common_macros.h"
+#include <avr/io.h>				/* to use the external interrupts registers */
+#include <avr/interrupt.h>		/* for INT0, INT1 and INT2 ISRs */
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+static volatile void (*g_extIntCallBack_ptr[3])(void) = {NULL_PTR, NULL_PTR, NULL_PTR};
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+ISR(INT0_vect)
+{
+	if(g_extIntCallBack_ptr[EXT_INT0])
+	{
+		(*g_extIntCallBack_ptr[EXT_INT0])();
+	}
+}
+
+ISR(INT1_vect)
+{
+	if(g_extIntCallBack_ptr[EXT_INT1])
+	{
+		(*g_extIntCallBack_ptr[EXT_INT1])();
+	}
+}
+
+ISR(INT2_vect)
+{
+	if(g_extIntCallBack_ptr[EXT_INT2])
+	{
+		(*g_extIntCallBack_ptr[EXT_INT2])();
+	}
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Configure the pin as input, set the trigger, clear any old request and enable the interrupt.
+ * Return FALSE if the trigger is not supported by the pin.
+ */
+uint8 EXT_INT_init(ExtInt_Id id, ExtInt_Sense sense)
+{
+	switch(id)
+	{
+	case EXT_INT0:
+		CLEAR_BIT(DDRD, PD2);
+		/* ISC01:ISC00 follow the order of ExtInt_Sense */
+		MCUCR = (MCUCR & ~((1<<ISC01) | (1<<ISC00))) | (sense << ISC00);
+		GIFR = (1<<INTF0);	/* the flag is cleared by writing one */
+		SET_BIT(GICR, INT0);
+		break;
+
+	case EXT_INT1:
+		CLEAR_BIT(DDRD, PD3);
+		/* ISC11:ISC10 follow the order of ExtInt_Sense */
+		MCUCR = (MCUCR & ~((1<<ISC11) | (1<<ISC10))) | (sense << ISC10);
+		GIFR = (1<<INTF1);
+		SET_BIT(GICR, INT1);
+		break;
+
+	case EXT_INT2:
+		if((sense != EXT_INT_FALLING_EDGE) && (sense != EXT_INT_RISING_EDGE))
+		{
+			return FALSE;
+		}
+		CLEAR_BIT(DDRB, PB2);
+		/* INT2 must be disabled while ISC2 changes, the change can set the flag */
+		CLEAR_BIT(GICR, INT2);
+		if(EXT_INT_RISING_EDGE == sense)
+		{
+			SET_BIT(MCUCSR, ISC2);
+		}
+		else
+		{
+			CLEAR_BIT(MCUCSR, ISC2);
+		}
+		GIFR = (1<<INTF2);
+		SET_BIT(GICR, INT2);
+		break;
+	}
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Disable the interrupt
+ */
+void EXT_INT_deInit(ExtInt_Id id)
+{
+	switch(id)
+	{
+	case EXT_INT0:
+		CLEAR_BIT(GICR, INT0);
+		break;
+
+	case EXT_INT1:
+		CLEAR_BIT(GICR, INT1);
+		break;
+
+	case EXT_INT2:
+		CLEAR_BIT(GICR, INT2);
+		break;
+	}
+}
+
+/*
+ * Description :
+ * sets the Call Back function address of the interrupt
+ */
+void EXT_INT_setCallBack(ExtInt_Id id, void(*a_ptr)(void))
+{
+	if(a_ptr)
+	{
+		g_extIntCallBack_ptr[id] = a_ptr;
+	}
+}
@@ -0,0 +1,65 @@
+ /******************************************************************************
+ *
+ * Module: EXT_INT
+ *
+ * File Name: ext_int.h
+ *
+ * Description: Header file for the ATmega32 External Interrupts driver
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#ifndef MCAL_EXT_INT_EXT_INT_H_
+#define MCAL_EXT_INT_EXT_INT_H_
+
+#include "../../std_types.h"
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* External interrupt pins: INT0 on PD2, INT1 on PD3, INT2 on PB2 */
+typedef enum
+{
+	EXT_INT0,
+	EXT_INT1,
+	EXT_INT2
+}ExtInt_Id;
+
+/*
+ * Interrupt trigger. INT2 only supports the two edges, and in power-down sleep
+ * INT0/INT1 can only wake the MCU on low level while INT2 wakes on its edge.
+ */
+typedef enum
+{
+	EXT_INT_LOW_LEVEL,
+	EXT_INT_ANY_CHANGE,
+	EXT_INT_FALLING_EDGE,
+	EXT_INT_RISING_EDGE
+}ExtInt_Sense;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Configure the pin as input, set the trigger, clear any old request and enable the interrupt.
+ * Return FALSE if the trigger is not supported by the pin.
+ */
+uint8 EXT_INT_init(ExtInt_Id id, ExtInt_Sense sense);
+
+/*
+ * Description :
+ * Disable the interrupt
+ */
+void EXT_INT_deInit(ExtInt_Id id);
+
+/*
+ * Description :
+ * sets the Call Back function address of the interrupt
+ */
+void EXT_INT_setCallBack(ExtInt_Id id, void(*a_ptr)(void));
+
+#endif /* MCAL_EXT_INT_EXT_INT_H_ */
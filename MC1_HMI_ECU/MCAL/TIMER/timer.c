@@ -11,19 +11,53 @@
  *******************************************************************************/
 #include "timer.h"
 #include "../../common_macros.h"
-#include <avr/io.h>				/* to use TIMER1 registers */
-#include <avr/interrupt.h>  	/* for TIMER1 ISR */
+#include <avr/io.h>				/* to use TIMER0, TIMER1 and TIMER2 registers */
+#include <avr/interrupt.h>  	/* for TIMER0, TIMER1 and TIMER2 ISRs */
 
 
 
 /*******************************************************************************
  *                           Global Variables                                  *
  *******************************************************************************/
+static volatile void (*Timer0_CallBack_ptr)(void) = NULL_PTR;
 static volatile void (*CallBack_ptr)(void) = NULL_PTR;
+static volatile void (*Timer2_CallBack_ptr)(void) = NULL_PTR;
 
 /*******************************************************************************
  *                       Interrupt Service Routines                            *
  *******************************************************************************/
+ISR(TIMER0_COMP_vect)
+{
+	if(Timer0_CallBack_ptr)
+	{
+		(*Timer0_CallBack_ptr)();
+	}
+}
+
+ISR(TIMER0_OVF_vect)
+{
+	if(Timer0_CallBack_ptr)
+	{
+		(*Timer0_CallBack_ptr)();
+	}
+}
+
+ISR(TIMER2_COMP_vect)
+{
+	if(Timer2_CallBack_ptr)
+	{
+		(*Timer2_CallBack_ptr)();
+	}
+}
+
+ISR(TIMER2_OVF_vect)
+{
+	if(Timer2_CallBack_ptr)
+	{
+		(*Timer2_CallBack_ptr)();
+	}
+}
+
 ISR(TIMER1_COMPA_vect)
 {
 	if(CallBack_ptr)
@@ -44,6 +78,154 @@ ISR(TIMER1_OVF_vect)
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
+/*
+ * Description :
+ * Initializes Timer0
+ */
+void Timer0_init(const Timer0_Config_t * Config_Ptr)
+{
+	/* 1. Check required timer mode*/
+	switch (Config_Ptr->mode)
+	{
+
+	case TIMER0_NORMAL_MODE:
+		/* if normal mode,
+		 * 					load required initial value in TCNT0 register,
+		 * 					Adjust WGM bits to normal mode
+		 * 					enable overflow interrupt */
+		TCNT0 = Config_Ptr->initial_value;
+
+		TCCR0 = (1<<FOC0); /* normal mode, OC0 disconnected */
+
+		SET_BIT(TIMSK, TOIE0); /* enable overflow interrupt */
+		break;
+
+	case TIMER0_CTC_MODE:
+		/* if CTC mode,
+		 * 				load required compare value in OCR0 register,
+		 * 				Adjust WGM bits to CTC mode
+		 * 				enable o/p compare match interrupt */
+		TCNT0 = Config_Ptr->initial_value;
+		OCR0 = Config_Ptr->compare_value;
+
+		TCCR0 = (1<<FOC0) | (1<<WGM01); /* CTC mode, OC0 disconnected */
+
+		SET_BIT(TIMSK, OCIE0); /* enable o/p compare match interrupt */
+		break;
+	}
+
+	/* reset prescaler bits then assign the required prescaler value */
+	TCCR0 = (TCCR0 & 0xF8) | (Config_Ptr->prescaler);
+}
+
+/*
+ * Description :
+ * Disable Timer0
+ */
+void Timer0_deInit(void)
+{
+	/* Clear All Timer0 Registers */
+	TCCR0 = 0;
+	TCNT0 = 0;
+	OCR0 = 0;
+
+	/* Clear timer0 used interrupt bits */
+	CLEAR_BIT(TIMSK, TOIE0);
+	CLEAR_BIT(TIMSK, OCIE0);
+}
+
+/*
+ * Description :
+ * sets the Timer0 Call Back function address
+ */
+void Timer0_setCallBack(void(*a_ptr)(void))
+{
+	if(a_ptr)
+	{
+		Timer0_CallBack_ptr = a_ptr;
+	}
+}
+
+/*
+ * Description :
+ * Return the current Timer0 count, the time since the last compare match in CTC mode
+ */
+uint8 Timer0_getCounter(void)
+{
+	return TCNT0;
+}
+
+/*
+ * Description :
+ * Initializes Timer2
+ */
+void Timer2_init(const Timer2_Config_t * Config_Ptr)
+{
+	/* Timer2 is started and stopped often, drop a match left from the last run */
+	TIFR = (1<<OCF2) | (1<<TOV2);
+
+	/* 1. Check required timer mode*/
+	switch (Config_Ptr->mode)
+	{
+
+	case TIMER2_NORMAL_MODE:
+		/* if normal mode,
+		 * 					load required initial value in TCNT2 register,
+		 * 					Adjust WGM bits to normal mode
+		 * 					enable overflow interrupt */
+		TCNT2 = Config_Ptr->initial_value;
+
+		TCCR2 = (1<<FOC2); /* normal mode, OC2 disconnected */
+
+		SET_BIT(TIMSK, TOIE2); /* enable overflow interrupt */
+		break;
+
+	case TIMER2_CTC_MODE:
+		/* if CTC mode,
+		 * 				load required compare value in OCR2 register,
+		 * 				Adjust WGM bits to CTC mode
+		 * 				enable o/p compare match interrupt */
+		TCNT2 = Config_Ptr->initial_value;
+		OCR2 = Config_Ptr->compare_value;
+
+		TCCR2 = (1<<FOC2) | (1<<WGM21); /* CTC mode, OC2 disconnected */
+
+		SET_BIT(TIMSK, OCIE2); /* enable o/p compare match interrupt */
+		break;
+	}
+
+	/* reset prescaler bits then assign the required prescaler value */
+	TCCR2 = (TCCR2 & 0xF8) | (Config_Ptr->prescaler);
+}
+
+/*
+ * Description :
+ * Disable Timer2
+ */
+void Timer2_deInit(void)
+{
+	/* Clear All Timer2 Registers */
+	TCCR2 = 0;
+	TCNT2 = 0;
+	OCR2 = 0;
+
+	/* Clear timer2 used interrupt bits */
+	CLEAR_BIT(TIMSK, TOIE2);
+	CLEAR_BIT(TIMSK, OCIE2);
+}
+
+/*
+ * Description :
+ * sets the Timer2 Call Back function address
+ */
+void Timer2_setCallBack(void(*a_ptr)(void))
+{
+	if(a_ptr)
+	{
+		Timer2_CallBack_ptr = a_ptr;
+	}
+}
+
 /*
  * Description :
  * Initializes the Timer driver
@@ -19,6 +19,60 @@
  *                                Definitions                                  *
  *******************************************************************************/
 
+/* This enum will be used to specify the prescaler used with Timer0 */
+typedef enum
+{
+	TIMER0_NO_CLOCK,
+	TIMER0_PRESCALER_1,
+	TIMER0_PRESCALER_8,
+	TIMER0_PRESCALER_64,
+	TIMER0_PRESCALER_256,
+	TIMER0_PRESCALER_1024,
+}Timer0_Prescaler;
+
+/* This enum will be used to specify the running mode of Timer0 */
+typedef enum
+{
+	TIMER0_NORMAL_MODE,
+	TIMER0_CTC_MODE
+}Timer0_Mode;
+
+/* This struct holds the initialization elements of Timer0 */
+typedef struct{
+	uint8 initial_value;
+	uint8 compare_value; // it will be used in compare mode only.
+	Timer0_Prescaler prescaler;
+	Timer0_Mode mode;
+} Timer0_Config_t;
+
+/* This enum will be used to specify the prescaler used with Timer2, it has more steps than Timer0 */
+typedef enum
+{
+	TIMER2_NO_CLOCK,
+	TIMER2_PRESCALER_1,
+	TIMER2_PRESCALER_8,
+	TIMER2_PRESCALER_32,
+	TIMER2_PRESCALER_64,
+	TIMER2_PRESCALER_128,
+	TIMER2_PRESCALER_256,
+	TIMER2_PRESCALER_1024,
+}Timer2_Prescaler;
+
+/* This enum will be used to specify the running mode of Timer2 */
+typedef enum
+{
+	TIMER2_NORMAL_MODE,
+	TIMER2_CTC_MODE
+}Timer2_Mode;
+
+/* This struct holds the initialization elements of Timer2 */
+typedef struct{
+	uint8 initial_value;
+	uint8 compare_value; // it will be used in compare mode only.
+	Timer2_Prescaler prescaler;
+	Timer2_Mode mode;
+} Timer2_Config_t;
+
 /* This enum will be used to specify the prescaler used with Timer1 */
 typedef enum
 {
@@ -50,6 +104,48 @@ typedef struct{
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
+/*
+ * Description :
+ * Initializes Timer0
+ */
+void Timer0_init(const Timer0_Config_t * Config_Ptr);
+
+/*
+ * Description :
+ * Disable Timer0
+ */
+void Timer0_deInit(void);
+
+/*
+ * Description :
+ * sets the Timer0 Call Back function address
+ */
+void Timer0_setCallBack(void(*a_ptr)(void));
+
+/*
+ * Description :
+ * Return the current Timer0 count, the time since the last compare match in CTC mode
+ */
+uint8 Timer0_getCounter(void);
+
+/*
+ * Description :
+ * Initializes Timer2
+ */
+void Timer2_init(const Timer2_Config_t * Config_Ptr);
+
+/*
+ * Description :
+ * Disable Timer2
+ */
+void Timer2_deInit(void);
+
+/*
+ * Description :
+ * sets the Timer2 Call Back function address
+ */
+void Timer2_setCallBack(void(*a_ptr)(void));
+
 /*
  * Description :
  * Initializes the Timer driver
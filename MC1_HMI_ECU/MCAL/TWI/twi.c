@@ -0,0 +1,308 @@
+ /******************************************************************************
+ *
+ * Module: TWI(I2C)
+ *
+ * File Name: twi.h
+ *
+ * Description: Source file for the TWI(I2C) AVR driver
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+ 
+#include "../TWI/twi.h"
+
+#include "../../common_macros.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>	/* for the TWI ISR */
+#include <util/delay.h>
+
+/*******************************************************************************
+ *                      Bit Rate Calculation                                   *
+ *******************************************************************************/
+
+/*
+ * SCL = F_CPU / (16 + 2 * TWBR * 4^TWPS)
+ * The smallest pre-scaler that fits TWBR in 8 bits is selected and TWBR is
+ * rounded up, so the generated SCL never exceeds the required frequency.
+ */
+#define TWI_DIV_CEIL(a,b)        (((a) + (b) - 1UL) / (b))
+
+#if ((F_CPU / TWI_SCL_FREQUENCY) < 16UL)
+#error "TWI_SCL_FREQUENCY is too high for this F_CPU, SCL can not exceed F_CPU/16"
+#endif
+
+#define TWI_BIT_RATE_SPAN        (TWI_DIV_CEIL(F_CPU, TWI_SCL_FREQUENCY) - 16UL)
+
+#if (TWI_DIV_CEIL(TWI_BIT_RATE_SPAN, 2UL) <= 255UL)
+#define TWI_TWPS_VALUE           0
+#define TWI_PRESCALER            1UL
+#elif (TWI_DIV_CEIL(TWI_BIT_RATE_SPAN, 8UL) <= 255UL)
+#define TWI_TWPS_VALUE           1
+#define TWI_PRESCALER            4UL
+#elif (TWI_DIV_CEIL(TWI_BIT_RATE_SPAN, 32UL) <= 255UL)
+#define TWI_TWPS_VALUE           2
+#define TWI_PRESCALER            16UL
+#elif (TWI_DIV_CEIL(TWI_BIT_RATE_SPAN, 128UL) <= 255UL)
+#define TWI_TWPS_VALUE           3
+#define TWI_PRESCALER            64UL
+#else
+#error "TWI_SCL_FREQUENCY is too low for this F_CPU"
+#endif
+
+#define TWI_TWBR_VALUE           TWI_DIV_CEIL(TWI_BIT_RATE_SPAN, 2UL * TWI_PRESCALER)
+#define TWI_SCL_ACTUAL           (F_CPU / (16UL + 2UL * TWI_TWBR_VALUE * TWI_PRESCALER))
+
+#if ((TWI_SCL_FREQUENCY - TWI_SCL_ACTUAL) * 100UL > TWI_SCL_FREQUENCY * TWI_SCL_MAX_ERROR_PERCENT)
+#error "Generated SCL frequency deviates more than TWI_SCL_MAX_ERROR_PERCENT from TWI_SCL_FREQUENCY"
+#endif
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Set when the last bus operation did not complete within TWI_TIMEOUT_US */
+static uint8 g_twi_timeout = FALSE;
+
+/* Transfer run by the TWI interrupt */
+static volatile uint8 g_twi_async_sla = 0;
+static volatile uint8 g_twi_async_data[TWI_ASYNC_MAX_BYTES];
+static volatile uint8 g_twi_async_count = 0;
+static volatile uint8 g_twi_async_index = 0;
+static volatile uint8 g_twi_async_sent = 0;		/* bytes acknowledged by the slave */
+static volatile uint8 g_twi_async_busy = FALSE;
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+
+ISR(TWI_vect)
+{
+	switch(TWSR & 0xF8)
+	{
+	case TWI_START:
+		TWDR = g_twi_async_sla;
+		TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+		break;
+
+	case TWI_MT_SLA_W_ACK:
+	case TWI_MT_DATA_ACK:
+		/* every byte loaded so far is acknowledged */
+		g_twi_async_sent = g_twi_async_index;
+		if(g_twi_async_index < g_twi_async_count)
+		{
+			TWDR = g_twi_async_data[g_twi_async_index++];
+			TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+			break;
+		}
+		/* all the bytes are sent, stop */
+		/* fall through */
+
+	default:
+		/* end of the transfer, or a NACK, a lost arbitration or a bus error ends it early */
+		TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+		g_twi_async_busy = FALSE;
+		break;
+	}
+}
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/*
+ * Wait for the TWINT flag with an upper bound of TWI_TIMEOUT_US,
+ * record the timeout so TWI_getStatus() reports it.
+ */
+static void TWI_waitForFlag(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void TWI_init(void)
+{
+    /* Bit Rate: TWI_SCL_FREQUENCY using the pre-scaler and TWBR computed at compile time */
+    TWBR = (uint8)TWI_TWBR_VALUE;
+	TWSR = TWI_TWPS_VALUE;
+	
+    /* Two Wire Bus address my address if any master device want to call me: 0x1 (used in case this MC is a slave device)
+       General Call Recognition: Off */
+    TWAR = 0b00000010; // my address = 0x01 :) 
+	
+    TWCR = (1<<TWEN); /* enable TWI */
+}
+
+void TWI_start(void)
+{
+    /* 
+	 * Clear the TWINT flag before sending the start bit TWINT=1
+	 * send the start bit by TWSTA=1
+	 * Enable TWI Module TWEN=1 
+	 */
+    TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN);
+    
+    /* Wait for TWINT flag set in TWCR Register (start bit is send successfully) */
+    TWI_waitForFlag();
+}
+
+void TWI_stop(void)
+{
+    /* 
+	 * Clear the TWINT flag before sending the stop bit TWINT=1
+	 * send the stop bit by TWSTO=1
+	 * Enable TWI Module TWEN=1 
+	 */
+    TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+}
+
+void TWI_writeByte(uint8 data)
+{
+    /* Put data On TWI data Register */
+    TWDR = data;
+    /* 
+	 * Clear the TWINT flag before sending the data TWINT=1
+	 * Enable TWI Module TWEN=1 
+	 */ 
+    TWCR = (1 << TWINT) | (1 << TWEN);
+    /* Wait for TWINT flag set in TWCR Register(data is send successfully) */
+    TWI_waitForFlag();
+}
+
+uint8 TWI_readByteWithACK(void)
+{
+	/* 
+	 * Clear the TWINT flag before reading the data TWINT=1
+	 * Enable sending ACK after reading or receiving data TWEA=1
+	 * Enable TWI Module TWEN=1 
+	 */ 
+    TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA);
+    /* Wait for TWINT flag set in TWCR Register (data received successfully) */
+    TWI_waitForFlag();
+    /* Read Data */
+    return TWDR;
+}
+
+uint8 TWI_readByteWithNACK(void)
+{
+	/* 
+	 * Clear the TWINT flag before reading the data TWINT=1
+	 * Enable TWI Module TWEN=1 
+	 */
+    TWCR = (1 << TWINT) | (1 << TWEN);
+    /* Wait for TWINT flag set in TWCR Register (data received successfully) */
+    TWI_waitForFlag();
+    /* Read Data */
+    return TWDR;
+}
+
+uint8 TWI_getStatus(void)
+{
+    uint8 status;
+
+    /* the hardware status is meaningless if the last operation never completed */
+    if(g_twi_timeout)
+    {
+        return TWI_TIMEOUT;
+    }
+
+    /* masking to eliminate first 3 bits and get the last 5 bits (status bits) */
+    status = TWSR & 0xF8;
+    return status;
+}
+
+uint8 TWI_recoverBus(void)
+{
+    uint8 clocks;
+
+    /* Disable the TWI module to get back the control of SCL and SDA pins */
+    TWCR = 0;
+
+    /*
+     * Emulate open drain outputs: the PORT bit stays 0 and the line is pulled
+     * low by making the pin output, released high (external pull-up) by making it input
+     */
+    CLEAR_BIT(PORTC,TWI_SCL_PIN_ID);
+    CLEAR_BIT(PORTC,TWI_SDA_PIN_ID);
+    CLEAR_BIT(DDRC,TWI_SCL_PIN_ID);
+    CLEAR_BIT(DDRC,TWI_SDA_PIN_ID);
+    _delay_us(5);
+
+    /* Clock the slave out of the byte it is stuck in until it releases SDA */
+    for(clocks = 0; (clocks < TWI_RECOVERY_CLOCKS) && BIT_IS_CLEAR(PINC,TWI_SDA_PIN_ID); clocks++)
+    {
+        SET_BIT(DDRC,TWI_SCL_PIN_ID);   /* SCL low  */
+        _delay_us(5);
+        CLEAR_BIT(DDRC,TWI_SCL_PIN_ID); /* SCL high */
+        _delay_us(5);
+    }
+
+    /* Generate a stop condition: SDA rising while SCL is high */
+    SET_BIT(DDRC,TWI_SCL_PIN_ID);       /* SCL low  */
+    _delay_us(5);
+    SET_BIT(DDRC,TWI_SDA_PIN_ID);       /* SDA low  */
+    _delay_us(5);
+    CLEAR_BIT(DDRC,TWI_SCL_PIN_ID);     /* SCL high */
+    _delay_us(5);
+    CLEAR_BIT(DDRC,TWI_SDA_PIN_ID);     /* SDA high */
+    _delay_us(5);
+
+    /* Give the pins back to the TWI module, a transfer of the interrupt is over */
+    g_twi_timeout = FALSE;
+    g_twi_async_busy = FALSE;
+    TWI_init();
+
+    return (BIT_IS_SET(PINC,TWI_SDA_PIN_ID) ? TRUE : FALSE);
+}
+
+uint8 TWI_writeAsync(uint8 slave_address, const uint8 *data, uint8 count)
+{
+	uint8 i;
+
+	if(TWI_isBusy() || (count > TWI_ASYNC_MAX_BYTES))
+	{
+		return FALSE;
+	}
+
+	g_twi_async_sla = slave_address << 1;	/* write request */
+	for(i = 0; i < count; i++)
+	{
+		g_twi_async_data[i] = data[i];
+	}
+	g_twi_async_count = count;
+	g_twi_async_index = 0;
+	g_twi_async_sent = 0;
+	g_twi_async_busy = TRUE;
+
+	/* send the start bit, the interrupt takes over from there */
+	TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+
+	return TRUE;
+}
+
+uint8 TWI_isBusy(void)
+{
+	/* the stop bit is cleared by the hardware once the stop condition is on the bus */
+	return (g_twi_async_busy || BIT_IS_SET(TWCR,TWSTO)) ? TRUE : FALSE;
+}
+
+uint8 TWI_getAsyncSent(void)
+{
+	return g_twi_async_sent;
+}
+
+static void TWI_waitForFlag(void)
+{
+    uint16 elapsed_us = 0;
+
+    g_twi_timeout = FALSE;
+    while(BIT_IS_CLEAR(TWCR,TWINT))
+    {
+        if(elapsed_us++ >= TWI_TIMEOUT_US)
+        {
+            g_twi_timeout = TRUE;
+            break;
+        }
+        _delay_us(1);
+    }
+}
@@ -13,6 +13,7 @@
 #include "uart.h"
 #include "avr/io.h" /* To use the UART Registers */
 #include "../../common_macros.h" /* To use the macros like SET_BIT */
+#include <avr/pgmspace.h> /* To read the strings kept in flash */
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -102,6 +103,25 @@ uint8 UART_recieveByte(void)
     return UDR;		
 }
 
+/*
+ * Description :
+ * Return TRUE if a received byte is waiting in the Rx buffer, without blocking.
+ */
+uint8 UART_isByteReceived(void)
+{
+	return (BIT_IS_SET(UCSRA,RXC) ? TRUE : FALSE);
+}
+
+/*
+ * Description :
+ * Return TRUE if no byte is waiting in the Tx buffer. UART_sendByte returns
+ * once its byte is shifted out, so the line is then idle too.
+ */
+uint8 UART_isTxEmpty(void)
+{
+	return (BIT_IS_SET(UCSRA,UDRE) ? TRUE : FALSE);
+}
+
 /*
  * Description :
  * Send the required string through UART to the other UART device.
@@ -127,6 +147,24 @@ void UART_sendString(const uint8 *Str)
 	*******************************************************************/
 }
 
+/*
+ * Description :
+ * Send the required string stored in flash (PROGMEM) through UART to the other UART device.
+ */
+void UART_sendString_P(const uint8 *Str)
+{
+	uint8 character;
+
+	/* Send the whole string, every byte is read from flash */
+	while((character = pgm_read_byte(Str)) != '\0')
+	{
+		UART_sendByte(character);
+		Str++;
+	}
+
+	UART_sendByte('#');
+}
+
 /*
  * Description :
  * Receive the required string until the '#' symbol through UART from the other UART device.
@@ -69,12 +69,31 @@ void UART_sendByte(const uint8 data);
  */
 uint8 UART_recieveByte(void);
 
+/*
+ * Description :
+ * Return TRUE if a received byte is waiting in the Rx buffer, without blocking.
+ */
+uint8 UART_isByteReceived(void);
+
+/*
+ * Description :
+ * Return TRUE if no byte is waiting in the Tx buffer. UART_sendByte returns
+ * once its byte is shifted out, so the line is then idle too.
+ */
+uint8 UART_isTxEmpty(void);
+
 /*
  * Description :
  * Send the required string through UART to the other UART device.
  */
 void UART_sendString(const uint8 *Str);
 
+/*
+ * Description :
+ * Send the required string stored in flash (PROGMEM) through UART to the other UART device.
+ */
+void UART_sendString_P(const uint8 *Str);
+
 /*
  * Description :
  * Receive the required string until the '#' symbol through UART from the other UART device.
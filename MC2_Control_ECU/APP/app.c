@@ -12,15 +12,24 @@
 #include "app.h"
 #include <avr/io.h>
 #include <avr/delay.h>
+#include <util/atomic.h>
 #include "../MCAL/UART/uart.h"
 #include "../MCAL/TWI/twi.h"
 #include "../HAL/BUZZER/buzzer.h"
 #include "../HAL/DC_MOTOR/dc_motor.h"
 #include "../HAL/EEPROM/external_eeprom.h"
+#include "../HAL/STORAGE/storage.h"
+#include "../HAL/EEPROM/eeprom_store.h"
+#include "../HAL/EEPROM/eeprom_scrub.h"
+#include "../HAL/CONFIG/config_store.h"
+#include "../HAL/AUDIT/audit_log.h"
 #include "../MCAL/TIMER/timer.h"
 #include "../HAL/BUZZER/buzzer.h"
 
-#define EEPROM_PASSWORD_LOCATION 0X0311
+/* Keys of the records kept in the eeprom record store */
+#define STORE_KEY_PASSWORD       0
+
+#define PASSWORD_MAX_SIZE        9
 
 
 /*******************************************************************************
@@ -63,22 +72,53 @@ uint8 isPassMatched(uint8 * pass1, uint8 * pass2, uint8 size);
 
 /*
  * Description :
- * 			The required function to be executed when timer interrupt is fired,
- * 			"increments ticks variable"
+ * 		This function sends the value of the requested configuration key to HMI_ECU
  */
-void TIMER1_callback_function(void);
+void getConfig(void);
+
+/*
+ * Description :
+ * 		This function changes the value of a configuration key and saves it to the EEPROM
+ */
+void setConfig(void);
+
+/*
+ * Description :
+ * 		This function streams the audit log to HMI_ECU, oldest record first
+ */
+void sendAuditLog(void);
+
+/*
+ * Description :
+ * 		This function tells HMI_ECU whether a password is stored in the EEPROM
+ */
+void sendPasswordStatus(void);
 
 /*
  * Description :
- * 			This function is to generate 15 seconds delay using timer1.
+ * 			The required function to be executed every 1ms by timer0,
+ * 			"counts the system uptime"
  */
-void TIMER1_delay_15sec(void);
+void TIMER0_callback_function(void);
 
 /*
  * Description :
- * 			This function is to generate 3 seconds delay using timer1.
+ * 			This function returns the seconds since the system started, used as audit timestamp
  */
-void TIMER1_delay_3sec(void);
+uint32 getUptime(void);
+
+/*
+ * Description :
+ * 			The required function to be executed when timer interrupt is fired,
+ * 			"increments ticks variable"
+ */
+void TIMER1_callback_function(void);
+
+/*
+ * Description :
+ * 			This function is to generate a delay of the given number of seconds using timer1.
+ */
+void TIMER1_delay_seconds(uint16 seconds);
 
 
 
@@ -92,6 +132,13 @@ uint8 pass_size = 0;
 /* used to store the required number of ticks of timer1 to generate a certain delay*/
 volatile uint8 ticks = 0;
 
+/* system uptime counted by timer0 */
+volatile uint16 uptime_ms = 0;
+volatile uint32 uptime_sec = 0;
+
+/* wrong passwords entered since the last correct one, logged with each check */
+uint8 failed_attempts = 0;
+
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
@@ -105,6 +152,9 @@ void APP_init(void)
 
 	UART_Config_t config = {UART_8_DATA_BITS, UART_PARITY_DISABLED,
 			UART_1_STOP_BIT, 9600};
+	/* Timer0 in CTC mode, 8MHz / 64 / (124 + 1) gives the 1ms uptime tick */
+	Timer0_Config_t tick_config = {0, 124, TIMER0_PRESCALER_64, TIMER0_CTC_MODE};
+	uint8 stored_pass[PASSWORD_MAX_SIZE];
 
 	/* Enable Global Interrupt */
 	SREG |= (1<<7);
@@ -112,6 +162,22 @@ void APP_init(void)
 	DcMotor_Init();
 	UART_init(&config);
 	Buzzer_init();
+	Timer0_setCallBack(TIMER0_callback_function);
+	Timer0_init(&tick_config);
+
+	/* load the site configuration to RAM, every operation reads its timings from there */
+	CONFIG_init();
+
+	/* index the eeprom record store, a torn write falls back to the previous password */
+	EEPROM_STORE_init();
+	if(EEPROM_STORE_read(STORE_KEY_PASSWORD, stored_pass, &pass_size) != SUCCESS)
+	{
+		pass_size = 0;
+	}
+
+	/* find the end of the audit log and record the startup */
+	AUDIT_init();
+	AUDIT_log(AUDIT_EVENT_BOOT, 1, 0, getUptime());
 }
 
 /*
@@ -123,6 +189,18 @@ void APP_start(void)
 	/* used to identify the required operation sent by HMI_ECU */
 	uint8 operation_id;
 
+	/* no request from HMI_ECU, use the idle time for the background tasks */
+	if(!UART_isByteReceived())
+	{
+		STORAGE_task();
+		if(EEPROM_SCRUB_task() != SUCCESS)
+		{
+			/* a bad record is still in the eeprom, the password reads as missing meanwhile */
+			AUDIT_log(AUDIT_EVENT_STORAGE_ERROR, 0, 0, getUptime());
+		}
+		return;
+	}
+
 	operation_id = UART_recieveByte();
 
 	switch(operation_id)
@@ -144,6 +222,22 @@ void APP_start(void)
 	case '3':	/* lock the system */
 		lockSystem();
 		break;
+
+	case '4':	/* read a configuration value */
+		getConfig();
+		break;
+
+	case '5':	/* change a configuration value */
+		setConfig();
+		break;
+
+	case '6':	/* read the audit log */
+		sendAuditLog();
+		break;
+
+	case '8':	/* is a password stored, asked by HMI_ECU at startup */
+		sendPasswordStatus();
+		break;
 	}
 }
 
@@ -155,22 +249,26 @@ void APP_start(void)
 void setPassword(void)
 {
 	uint8 received_pass[10] = "";
-	uint8 i;
-	/* reset pass_size , i */
+	uint8 status;
+
+	/* reset pass_size */
 	pass_size = 0;
-	i = 0;
 
 	/* store the user entered password */
 	UART_receiveString(received_pass);
 
-	/* store password in eeprom */
-	while(received_pass[i])
+	while(received_pass[pass_size])
 	{
-		EEPROM_writeByte(EEPROM_PASSWORD_LOCATION + i, received_pass[i]);
-		_delay_ms(10);
 		pass_size++;
-		i++;
 	}
+
+	/* append the password to the wear-leveled record store in the external eeprom,
+	 * it is written by the write-behind buffer in the background */
+	status = EEPROM_STORE_write(STORE_KEY_PASSWORD, received_pass, pass_size);
+	AUDIT_log(AUDIT_EVENT_PASSWORD_SET, (SUCCESS == status), 0, getUptime());
+
+	/* acknowledge the new password to HMI_ECU, '0' if it could not be stored */
+	UART_sendByte((SUCCESS == status) ? '1' : '0');
 }
 
 
@@ -180,10 +278,8 @@ void setPassword(void)
  */
 void verifyPassword(void)
 {
-	/* isMathed is a flag that is set when password is correct,
-	 * i is a counter used when reading from EEPROM
-	 */
-	uint8 isMatched, i;
+	/* isMathed is a flag that is set when password is correct */
+	uint8 isMatched;
 	uint8 received_pass[10] = "";
 
 
@@ -193,23 +289,30 @@ void verifyPassword(void)
 	/* store the user entered password */
 	UART_receiveString(received_pass);
 
-	/* extract saved password from EEPROM */
-	for(i = 0; i < pass_size; i++)
+	/* extract saved password from EEPROM, including the bytes not written yet */
+	if(EEPROM_STORE_read(STORE_KEY_PASSWORD, stored_pass, &pass_size) != SUCCESS)
 	{
-		EEPROM_readByte(EEPROM_PASSWORD_LOCATION + i, &stored_pass[i]);
-		_delay_ms(10);
+		/* no password or a corrupted one, nothing may match it */
+		pass_size = 0;
+		isMatched = FALSE;
 	}
-
-	/* check if the user entered password && stored password are identical */
-	isMatched = isPassMatched(received_pass, stored_pass, pass_size);
+	else
+	{
+		/* check if the user entered password && stored password are identical */
+		isMatched = isPassMatched(received_pass, stored_pass, pass_size);
+	}
+	AUDIT_log(AUDIT_EVENT_PASSWORD_CHECK, isMatched, failed_attempts + 1, getUptime());
 	if(isMatched)
 	{
+		failed_attempts = 0;
+
 		/* if matched, send '1' */
 		UART_sendByte('1');
 	}
 	else
 	{
 		/* if not matched, send '0' */
+		failed_attempts++;
 		UART_sendByte('0');
 	}
 
@@ -244,43 +347,160 @@ uint8 isPassMatched(uint8 * pass1, uint8 * pass2, uint8 size)
 
 /*
  * Description :
- * 			This function is to generate 15 seconds delay using timer1.
+ * 		This function sends the value of the requested configuration key to HMI_ECU
+ * 		Request: '4' [key]   Response: [value low byte] [value high byte]
  */
-void TIMER1_delay_15sec(void)
+void getConfig(void)
 {
-	/* Timer operates in CTC mode, required OCR value to generate 15 seconds
-	 * at 1024 pre-scaler is 58594 for 2 times,
-	 * for TCNT1 element is configuration can be any dummy number'1000'*/
-	Timer1_Config_t config = { 1000 , 58594, TIMER1_PRESCALER_1024, TIMER1_CTC_MODE};
-	Timer1_init(&config);
+	uint8 key;
+	uint16 value;
 
-	Timer1_setCallBack(TIMER1_callback_function);
-	while(ticks < 2);
-	ticks = 0;
-	Timer1_deInit();
+	key = UART_recieveByte();
+	value = CONFIG_get(key);
+
+	UART_sendByte((uint8)value);
+	UART_sendByte((uint8)(value >> 8));
+}
+
+/*
+ * Description :
+ * 		This function changes the value of a configuration key and saves it to the EEPROM
+ * 		Request: '5' [key] [value low byte] [value high byte]   Response: '1' done, '0' rejected
+ */
+void setConfig(void)
+{
+	uint8 key;
+	uint16 value;
+
+	key = UART_recieveByte();
+	value = UART_recieveByte();
+	value |= (uint16)UART_recieveByte() << 8;
+
+	if(CONFIG_set(key, value) == SUCCESS)
+	{
+		AUDIT_log(AUDIT_EVENT_CONFIG_SET, 1, key, getUptime());
+		UART_sendByte('1');
+	}
+	else
+	{
+		AUDIT_log(AUDIT_EVENT_CONFIG_SET, 0, key, getUptime());
+		UART_sendByte('0');
+	}
+}
+
+/*
+ * Description :
+ * 		This function streams the audit log to HMI_ECU, oldest record first
+ * 		Request: '6'
+ * 		Response: [boot] [uptime, 4 bytes] [count lo] [count hi] then count records of AUDIT_RECORD_SIZE bytes,
+ * 		all little endian. The boot number and uptime of this power cycle let the reader turn the
+ * 		timestamps of its records into clock time, older power cycles are ordered by their boot number.
+ */
+void sendAuditLog(void)
+{
+	uint8 record[AUDIT_RECORD_SIZE];
+	uint32 now = getUptime();
+	uint16 count = AUDIT_getCount();
+	uint16 index;
+	uint8 i;
+
+	UART_sendByte(AUDIT_getBoot());
+	for(i = 0; i < 4; i++)
+	{
+		UART_sendByte((uint8)(now >> (8 * i)));
+	}
+	UART_sendByte((uint8)count);
+	UART_sendByte((uint8)(count >> 8));
+
+	for(index = 0; index < count; index++)
+	{
+		if(AUDIT_readRecord(index, record) != SUCCESS)
+		{
+			/* keep the stream length, an unreadable record is sent erased */
+			for(i = 0; i < AUDIT_RECORD_SIZE; i++)
+			{
+				record[i] = 0xFF;
+			}
+		}
+
+		for(i = 0; i < AUDIT_RECORD_SIZE; i++)
+		{
+			UART_sendByte(record[i]);
+		}
+	}
+}
+
+/*
+ * Description :
+ * 		This function tells HMI_ECU whether a password is stored in the EEPROM,
+ * 		a restarted HMI_ECU only asks for a new one when there is none. A password
+ * 		erased by the scrubber after a CRC error counts as none.
+ * 		Request: '8'   Response: '1' stored, '0' none
+ */
+void sendPasswordStatus(void)
+{
+	uint8 stored_pass[PASSWORD_MAX_SIZE];
+
+	if(EEPROM_STORE_read(STORE_KEY_PASSWORD, stored_pass, &pass_size) != SUCCESS)
+	{
+		pass_size = 0;
+	}
+	UART_sendByte((pass_size > 0) ? '1' : '0');
+}
+
+/*
+ * Description :
+ * 			The required function to be executed every 1ms by timer0,
+ * 			"counts the system uptime"
+ */
+void TIMER0_callback_function(void)
+{
+	if(++uptime_ms >= 1000)
+	{
+		uptime_ms = 0;
+		uptime_sec++;
+	}
 }
 
+/*
+ * Description :
+ * 			This function returns the seconds since the system started, used as audit timestamp
+ */
+uint32 getUptime(void)
+{
+	uint32 seconds;
+
+	/* the 4 bytes are read one by one, keep the timer0 interrupt from changing them in between */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		seconds = uptime_sec;
+	}
+
+	return seconds;
+}
 
 /*
  * Description :
- * 			This function is to generate 3 seconds delay using timer1.
+ * 			This function is to generate a delay of the given number of seconds using timer1.
  */
-void TIMER1_delay_3sec(void)
+void TIMER1_delay_seconds(uint16 seconds)
 {
-	/* Timer operates in CTC mode, required OCR value to generate 3 seconds
-	 * at 1024 pre-scaler is 23450,
+	/* Timer operates in CTC mode, required OCR value to generate 1 second
+	 * at 1024 pre-scaler is 7813,
 	 * for TCNT1 element is configuration can be any dummy number'1000'*/
-	Timer1_Config_t config = { 1000 , 23500, TIMER1_PRESCALER_1024, TIMER1_CTC_MODE};
+	Timer1_Config_t config = { 1000 , 7813, TIMER1_PRESCALER_1024, TIMER1_CTC_MODE};
 	Timer1_init(&config);
 
 	/* set callback function for timer1 interrupt */
 	Timer1_setCallBack(TIMER1_callback_function);
 
-	/* wait for timer interrupt */
-	while(!ticks);
+	/* count the seconds, the timer keeps running so no time is lost between them */
+	while(seconds--)
+	{
+		while(!ticks);
+		ticks = 0;
+	}
 
-	/* reset ticks variable for next future use */
-	ticks = 0;
 	Timer1_deInit();
 }
 
@@ -301,17 +521,18 @@ void TIMER1_callback_function(void)
  */
 void lockSystem(void)
 {
-	/* The control ECU is required to turn on the buzzer for 1 minute when system
+	/* The control ECU is required to turn on the buzzer for the lockout time when system
 	 * goes to the locked state
 	 */
-	uint8 timer_counter = 0;	/* used to repeat the 15sec delay function to get 1 minute */
+	AUDIT_log(AUDIT_EVENT_LOCKOUT, 1, failed_attempts, getUptime());
+	failed_attempts = 0;
+
+	/* background tasks are stopped during the lockout, commit the pending eeprom writes first */
+	STORAGE_flush(STORAGE_EXTERNAL_EEPROM);
 
-	/* turn on buzzer for 1 minute */
+	/* turn on buzzer for the lockout time */
 	Buzzer_on();
-	while(timer_counter++ < 4)
-	{
-		TIMER1_delay_15sec();
-	}
+	TIMER1_delay_seconds(CONFIG_get(CONFIG_KEY_LOCKOUT_SEC));
 	Buzzer_off();
 }
 
@@ -321,17 +542,22 @@ void lockSystem(void)
  */
 void openGate(void)
 {
-	/* open the door by rotating the DC motor CW for 15 seconds */
+	AUDIT_log(AUDIT_EVENT_DOOR_OPEN, 1, 0, getUptime());
+
+	/* background tasks are stopped while the door moves, commit the pending eeprom writes first */
+	STORAGE_flush(STORAGE_EXTERNAL_EEPROM);
+
+	/* open the door by rotating the DC motor CW for the motor run time */
 	DcMotor_Rotate(CW);
-	TIMER1_delay_15sec();
+	TIMER1_delay_seconds(CONFIG_get(CONFIG_KEY_MOTOR_RUN_SEC));
 
-	/* keep the door open for 3 seconds */
+	/* keep the door open for the hold time */
 	DcMotor_Rotate(STOP);
-	TIMER1_delay_3sec();
+	TIMER1_delay_seconds(CONFIG_get(CONFIG_KEY_DOOR_HOLD_SEC));
 
-	/* lock the door by rotating the DC motor ACW for 15 seconds */
+	/* lock the door by rotating the DC motor ACW for the motor run time */
 	DcMotor_Rotate(A_CW);
-	TIMER1_delay_15sec();
+	TIMER1_delay_seconds(CONFIG_get(CONFIG_KEY_MOTOR_RUN_SEC));
 
 	/* stop the motor */
 	DcMotor_Rotate(STOP);
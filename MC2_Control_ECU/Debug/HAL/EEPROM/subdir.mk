@@ -4,12 +4,24 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../HAL/EEPROM/eeprom_scrub.c \
+../HAL/EEPROM/eeprom_slots.c \
+../HAL/EEPROM/eeprom_store.c \
+../HAL/EEPROM/eeprom_write_behind.c \
 ../HAL/EEPROM/external_eeprom.c 
 
 OBJS += \
+./HAL/EEPROM/eeprom_scrub.o \
+./HAL/EEPROM/eeprom_slots.o \
+./HAL/EEPROM/eeprom_store.o \
+./HAL/EEPROM/eeprom_write_behind.o \
 ./HAL/EEPROM/external_eeprom.o 
 
 C_DEPS += \
+./HAL/EEPROM/eeprom_scrub.d \
+./HAL/EEPROM/eeprom_slots.d \
+./HAL/EEPROM/eeprom_store.d \
+./HAL/EEPROM/eeprom_write_behind.d \
 ./HAL/EEPROM/external_eeprom.d 
 
 
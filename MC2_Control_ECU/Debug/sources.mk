@@ -21,10 +21,14 @@ C_DEPS :=
 # Every subdirectory with source files must be described here
 SUBDIRS := \
 APP \
+HAL/AUDIT \
 HAL/BUZZER \
+HAL/CONFIG \
 HAL/DC_MOTOR \
 HAL/EEPROM \
+HAL/STORAGE \
 . \
+MCAL/EEPROM \
 MCAL/GPIO \
 MCAL/TIMER \
 MCAL/TWI \
@@ -0,0 +1,236 @@
+ /******************************************************************************
+ *
+ * Module: AUDIT
+ *
+ * File Name: audit_log.c
+ *
+ * Description: Source file for the access audit log in the External EEPROM
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#include "audit_log.h"
+#include "../STORAGE/storage.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Sequence number read from a record that was never written */
+#define AUDIT_SEQ_ERASED          0xFFFF
+
+/* Byte of the boot number in a record */
+#define AUDIT_BOOT_OFFSET         4
+
+#define RECORD_ADDRESS(slot)      (AUDIT_START_ADDR + ((uint16)(slot) * AUDIT_RECORD_SIZE))
+#define PAGE_FIRST_SLOT(slot)     ((slot) - ((slot) % AUDIT_RECORDS_PER_PAGE))
+
+/* Events that must survive a reset, they are written without waiting for a full page */
+#define AUDIT_IS_SECURITY_EVENT(event)  (((event) == AUDIT_EVENT_PASSWORD_SET) || ((event) == AUDIT_EVENT_DOOR_OPEN) || \
+										 ((event) == AUDIT_EVENT_LOCKOUT) || ((event) == AUDIT_EVENT_CONFIG_SET) || \
+										 ((event) == AUDIT_EVENT_STORAGE_ERROR))
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* RAM copy of the eeprom page holding the next record */
+static uint8 g_audit_page[EEPROM_PAGE_SIZE];
+
+static uint16 g_audit_head = 0;		/* slot of the next record */
+static uint16 g_audit_count = 0;	/* records in the log */
+static uint16 g_audit_seq = AUDIT_SEQ_ERASED;	/* sequence number of the newest record */
+static uint8 g_audit_boot = 0;		/* boot number of this power cycle */
+
+/*******************************************************************************
+ *                      Private Functions Prototypes                           *
+ *******************************************************************************/
+
+static uint16 AUDIT_nextSeq(uint16 seq);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Scan the ring once to find the newest record and continue the log after it,
+ * the boot number of this power cycle is the one of the newest record plus one.
+ */
+void AUDIT_init(void)
+{
+	uint8 page[EEPROM_PAGE_SIZE];
+	uint16 slot, seq = AUDIT_SEQ_ERASED;
+	uint8 offset, i;
+
+	g_audit_head = 0;
+	g_audit_count = AUDIT_NUM_RECORDS;
+	g_audit_seq = AUDIT_SEQ_ERASED;
+	g_audit_boot = 0;
+
+	/*
+	 * records are written in order so their sequence numbers increase by one
+	 * along the ring, the head is the first slot breaking the chain
+	 */
+	for(slot = 0; slot < AUDIT_NUM_RECORDS; slot++)
+	{
+		offset = (slot % AUDIT_RECORDS_PER_PAGE) * AUDIT_RECORD_SIZE;
+		if(0 == offset)
+		{
+			if(STORAGE_read(STORAGE_EXTERNAL_EEPROM, RECORD_ADDRESS(slot), page, EEPROM_PAGE_SIZE) != STORAGE_OK)
+			{
+				/* an unreadable page ends the log like an erased one */
+				for(i = 0; i < EEPROM_PAGE_SIZE; i++)
+				{
+					page[i] = 0xFF;
+				}
+			}
+		}
+
+		seq = page[offset] | ((uint16)page[offset + 1] << 8);
+
+		if((AUDIT_SEQ_ERASED == seq) || ((slot != 0) && (seq != AUDIT_nextSeq(g_audit_seq))))
+		{
+			g_audit_head = slot;
+			break;
+		}
+
+		g_audit_seq = seq;
+		g_audit_boot = page[offset + AUDIT_BOOT_OFFSET] + 1;
+	}
+
+	/* the ring did not wrap yet if the slot after the newest record was never written */
+	if(AUDIT_SEQ_ERASED == seq)
+	{
+		g_audit_count = g_audit_head;
+	}
+
+	/* continue filling the page of the head, its older records are written back with it */
+	for(i = 0; i < EEPROM_PAGE_SIZE; i++)
+	{
+		g_audit_page[i] = 0xFF;
+	}
+	if(g_audit_head % AUDIT_RECORDS_PER_PAGE)
+	{
+		STORAGE_read(STORAGE_EXTERNAL_EEPROM, RECORD_ADDRESS(PAGE_FIRST_SLOT(g_audit_head)), g_audit_page, EEPROM_PAGE_SIZE);
+	}
+}
+
+/*
+ * Description :
+ * Append a record. Records are collected in a RAM copy of the current eeprom
+ * page and the page is written once it is full, so routine events never cost
+ * their own eeprom write cycle. A security event (password set, door open,
+ * lockout, configuration change, storage error) writes the page at once
+ * together with the records before it, only routine records after the last
+ * one can be lost on a power cut.
+ */
+void AUDIT_log(Audit_Event event, uint8 result, uint8 attempt, uint32 timestamp)
+{
+	uint8 * record = &g_audit_page[(g_audit_head % AUDIT_RECORDS_PER_PAGE) * AUDIT_RECORD_SIZE];
+	uint16 page_slot = PAGE_FIRST_SLOT(g_audit_head);
+	uint8 i;
+
+	g_audit_seq = AUDIT_nextSeq(g_audit_seq);
+
+	if(timestamp > AUDIT_TIMESTAMP_MAX)
+	{
+		timestamp = AUDIT_TIMESTAMP_MAX;
+	}
+
+	record[0] = (uint8)g_audit_seq;
+	record[1] = (uint8)(g_audit_seq >> 8);
+	record[2] = (uint8)((event << 4) | (result & 0x0F));
+	record[3] = attempt;
+	record[AUDIT_BOOT_OFFSET] = g_audit_boot;
+	record[5] = (uint8)timestamp;
+	record[6] = (uint8)(timestamp >> 8);
+	record[7] = (uint8)(timestamp >> 16);
+
+	g_audit_head = (g_audit_head + 1) % AUDIT_NUM_RECORDS;
+	if(g_audit_count < AUDIT_NUM_RECORDS)
+	{
+		g_audit_count++;
+	}
+
+	if(0 == (g_audit_head % AUDIT_RECORDS_PER_PAGE))
+	{
+		/* the page is full, hand it to the write-behind buffer as a single page write */
+		STORAGE_write(STORAGE_EXTERNAL_EEPROM, RECORD_ADDRESS(page_slot), g_audit_page, EEPROM_PAGE_SIZE);
+
+		for(i = 0; i < EEPROM_PAGE_SIZE; i++)
+		{
+			g_audit_page[i] = 0xFF;
+		}
+	}
+	else if(AUDIT_IS_SECURITY_EVENT(event))
+	{
+		/*
+		 * write the records of the page collected so far, the bytes already in the
+		 * eeprom are dropped by the write-behind buffer when the page is completed
+		 */
+		STORAGE_write(STORAGE_EXTERNAL_EEPROM, RECORD_ADDRESS(page_slot), g_audit_page,
+				(g_audit_head - page_slot) * AUDIT_RECORD_SIZE);
+	}
+}
+
+/*
+ * Description :
+ * Return the number of records in the log, including the ones still in RAM.
+ */
+uint16 AUDIT_getCount(void)
+{
+	return g_audit_count;
+}
+
+/*
+ * Description :
+ * Return the boot number stored in the records of this power cycle.
+ */
+uint8 AUDIT_getBoot(void)
+{
+	return g_audit_boot;
+}
+
+/*
+ * Description :
+ * Copy the raw AUDIT_RECORD_SIZE bytes of a record, index 0 is the oldest one.
+ * Return ERROR if the index is outside the log or the eeprom can not be read.
+ */
+uint8 AUDIT_readRecord(uint16 index, uint8 * record)
+{
+	uint16 slot;
+	uint8 i;
+
+	if(index >= g_audit_count)
+	{
+		return ERROR;
+	}
+
+	/* once the ring wrapped the oldest record is the one at the head */
+	slot = (AUDIT_NUM_RECORDS == g_audit_count) ? ((g_audit_head + index) % AUDIT_NUM_RECORDS) : index;
+
+	if((slot >= PAGE_FIRST_SLOT(g_audit_head)) && (slot < g_audit_head))
+	{
+		/* not written to the eeprom yet */
+		for(i = 0; i < AUDIT_RECORD_SIZE; i++)
+		{
+			record[i] = g_audit_page[(slot % AUDIT_RECORDS_PER_PAGE) * AUDIT_RECORD_SIZE + i];
+		}
+		return SUCCESS;
+	}
+
+	return (STORAGE_read(STORAGE_EXTERNAL_EEPROM, RECORD_ADDRESS(slot), record, AUDIT_RECORD_SIZE) == STORAGE_OK) ? SUCCESS : ERROR;
+}
+
+static uint16 AUDIT_nextSeq(uint16 seq)
+{
+	/* the erased value is never used as a sequence number */
+	seq++;
+	if(AUDIT_SEQ_ERASED == seq)
+	{
+		seq = 0;
+	}
+	return seq;
+}
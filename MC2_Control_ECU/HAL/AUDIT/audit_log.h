@@ -0,0 +1,106 @@
+ /******************************************************************************
+ *
+ * Module: AUDIT
+ *
+ * File Name: audit_log.h
+ *
+ * Description: Header file for the access audit log in the External EEPROM
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#ifndef AUDIT_LOG_H_
+#define AUDIT_LOG_H_
+
+#include "../../std_types.h"
+#include "../EEPROM/external_eeprom.h"
+#include "../STORAGE/storage.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Ring of records filling the audit partition of the external EEPROM */
+#define AUDIT_START_ADDR          STORAGE_AUDIT_PARTITION_ADDR
+#define AUDIT_NUM_PAGES           (STORAGE_AUDIT_PARTITION_SIZE / EEPROM_PAGE_SIZE)
+
+/*
+ * Record layout, little endian:
+ * [seq lo][seq hi][event << 4 | result][attempt][boot][timestamp, 3 bytes]
+ * boot numbers the power cycle that wrote the record, the timestamp is the
+ * uptime in seconds within that power cycle and stops at AUDIT_TIMESTAMP_MAX.
+ * Every power cycle logs a boot event, so the ring never holds more power
+ * cycles than records and an 8-bit boot number is never ambiguous.
+ */
+#define AUDIT_RECORD_SIZE         8
+#define AUDIT_RECORDS_PER_PAGE    (EEPROM_PAGE_SIZE / AUDIT_RECORD_SIZE)
+#define AUDIT_NUM_RECORDS         (AUDIT_NUM_PAGES * AUDIT_RECORDS_PER_PAGE)
+#define AUDIT_TIMESTAMP_MAX       0x00FFFFFFUL
+
+#if (AUDIT_NUM_RECORDS > 256)
+#error "An 8-bit boot number needs a ring of at most 256 records"
+#endif
+
+#if ((AUDIT_START_ADDR % EEPROM_PAGE_SIZE) || (STORAGE_AUDIT_PARTITION_SIZE % EEPROM_PAGE_SIZE))
+#error "The audit partition must be a whole number of eeprom pages"
+#endif
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Events kept in the log, the values are stored so new events are appended */
+typedef enum
+{
+	AUDIT_EVENT_BOOT,			/* Control_ECU started */
+	AUDIT_EVENT_PASSWORD_SET,	/* a new password is saved */
+	AUDIT_EVENT_PASSWORD_CHECK,	/* a password is checked, result 1 if correct */
+	AUDIT_EVENT_DOOR_OPEN,		/* the door is opened */
+	AUDIT_EVENT_LOCKOUT,		/* all the password trials are used */
+	AUDIT_EVENT_CONFIG_SET,		/* a configuration value is changed, attempt holds the key */
+	AUDIT_EVENT_STORAGE_ERROR	/* a bad record found by the scrubber could not be erased or rewritten */
+}Audit_Event;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Scan the ring once to find the newest record and continue the log after it,
+ * the boot number of this power cycle is the one of the newest record plus one.
+ */
+void AUDIT_init(void);
+
+/*
+ * Description :
+ * Append a record. Records are collected in a RAM copy of the current eeprom
+ * page and the page is written once it is full, so routine events never cost
+ * their own eeprom write cycle. A security event (password set, door open,
+ * lockout, configuration change, storage error) writes the page at once
+ * together with the records before it, only routine records after the last
+ * one can be lost on a power cut.
+ */
+void AUDIT_log(Audit_Event event, uint8 result, uint8 attempt, uint32 timestamp);
+
+/*
+ * Description :
+ * Return the number of records in the log, including the ones still in RAM.
+ */
+uint16 AUDIT_getCount(void);
+
+/*
+ * Description :
+ * Return the boot number stored in the records of this power cycle.
+ */
+uint8 AUDIT_getBoot(void);
+
+/*
+ * Description :
+ * Copy the raw AUDIT_RECORD_SIZE bytes of a record, index 0 is the oldest one.
+ * Return ERROR if the index is outside the log or the eeprom can not be read.
+ */
+uint8 AUDIT_readRecord(uint16 index, uint8 * record);
+
+#endif /* AUDIT_LOG_H_ */
@@ -0,0 +1,214 @@
+ /******************************************************************************
+ *
+ * Module: CONFIG
+ *
+ * File Name: config_store.c
+ *
+ * Description: Source file for the key-value configuration store
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#include "config_store.h"
+#include "../EEPROM/external_eeprom.h"
+#include "../EEPROM/eeprom_slots.h"
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+typedef struct
+{
+	Config_Type type;
+	uint16 default_value;
+	uint16 min;
+	uint16 max;
+}Config_KeyInfo_t;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Type and valid range of each key, indexed by the key ID */
+static const Config_KeyInfo_t g_config_keys[CONFIG_NUM_KEYS] =
+{
+	{CONFIG_TYPE_UINT8,  CONFIG_DEFAULT_MOTOR_RUN_SEC, 1,  120},	/* CONFIG_KEY_MOTOR_RUN_SEC */
+	{CONFIG_TYPE_UINT8,  CONFIG_DEFAULT_DOOR_HOLD_SEC, 1,  60},	/* CONFIG_KEY_DOOR_HOLD_SEC */
+	{CONFIG_TYPE_UINT16, CONFIG_DEFAULT_LOCKOUT_SEC,   10, 3600},	/* CONFIG_KEY_LOCKOUT_SEC */
+	{CONFIG_TYPE_UINT8,  CONFIG_DEFAULT_MAX_TRIALS,    1,  9}		/* CONFIG_KEY_MAX_TRIALS */
+};
+
+/* RAM copy of the values, indexed by the key ID so a lookup costs one array access */
+static uint16 g_config_values[CONFIG_NUM_KEYS];
+
+static EEPROM_SLOT_Record_t g_config_record =
+{
+	CONFIG_STORE_DEVICE, {CONFIG_SLOT_A_ADDR, CONFIG_SLOT_B_ADDR}, EEPROM_SLOT_MAX_PAYLOAD, EEPROM_SLOT_NONE, 0
+};
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/*
+ * Write the RAM table to the next slot of the configuration record.
+ */
+static uint8 CONFIG_save(void);
+
+/*
+ * Serialize the RAM table into image as [key][value low][value high if uint16], return its size.
+ */
+static uint8 CONFIG_buildImage(uint8 * image);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Load the configuration record into the RAM table. Keys missing from the
+ * record or out of their range get the default value.
+ */
+void CONFIG_init(void)
+{
+	uint8 image[EEPROM_SLOT_MAX_PAYLOAD];
+	uint8 size = 0;
+	uint8 i = 0;
+	uint8 key;
+	uint16 value;
+
+	for(key = 0; key < CONFIG_NUM_KEYS; key++)
+	{
+		g_config_values[key] = g_config_keys[key].default_value;
+	}
+
+	if(EEPROM_SLOT_load(&g_config_record, image, &size) != SUCCESS)
+	{
+		/* never configured, run with the defaults */
+		return;
+	}
+
+	/* the record is a list of [key ID][value], the value takes 1 or 2 bytes by the key type */
+	while(i < size)
+	{
+		key = image[i++];
+		if(key >= CONFIG_NUM_KEYS)
+		{
+			/* written by a newer firmware, the size of the value is unknown so stop here */
+			break;
+		}
+
+		if(CONFIG_TYPE_UINT16 == g_config_keys[key].type)
+		{
+			if((i + 2) > size)
+			{
+				break;
+			}
+			value = image[i] | ((uint16)image[i + 1] << 8);
+			i += 2;
+		}
+		else
+		{
+			if((i + 1) > size)
+			{
+				break;
+			}
+			value = image[i++];
+		}
+
+		if((value >= g_config_keys[key].min) && (value <= g_config_keys[key].max))
+		{
+			g_config_values[key] = value;
+		}
+	}
+}
+
+/*
+ * Description :
+ * Return the value of the key from the RAM table, 0 for an unknown key.
+ */
+uint16 CONFIG_get(uint8 key)
+{
+	if(key >= CONFIG_NUM_KEYS)
+	{
+		return 0;
+	}
+
+	return g_config_values[key];
+}
+
+/*
+ * Description :
+ * Change the value of the key and save the configuration record.
+ * Return ERROR if the key is unknown or the value is out of its range.
+ */
+uint8 CONFIG_set(uint8 key, uint16 value)
+{
+	if((key >= CONFIG_NUM_KEYS) || (value < g_config_keys[key].min) || (value > g_config_keys[key].max))
+	{
+		return ERROR;
+	}
+
+	if(g_config_values[key] == value)
+	{
+		/* nothing changed, save an EEPROM write */
+		return SUCCESS;
+	}
+
+	g_config_values[key] = value;
+
+	return CONFIG_save();
+}
+
+/*
+ * Description :
+ * Check one slot (0 or 1) of the configuration record. A bad slot is rewritten
+ * in place from the RAM table and the other slot is left untouched, repaired
+ * tells if the rewrite succeeded.
+ * Return FALSE if the slot was bad.
+ */
+uint8 CONFIG_checkSlot(uint8 slot, uint8 * repaired)
+{
+	uint8 image[EEPROM_SLOT_MAX_PAYLOAD];
+	uint8 size;
+
+	*repaired = FALSE;
+
+	if(EEPROM_SLOT_check(&g_config_record, slot))
+	{
+		return TRUE;
+	}
+
+	/* rewrite the bad slot in place from the RAM table, the good slot may be the only valid copy */
+	size = CONFIG_buildImage(image);
+	*repaired = (EEPROM_SLOT_rewrite(&g_config_record, slot, image, size) == SUCCESS) ? TRUE : FALSE;
+
+	return FALSE;
+}
+
+static uint8 CONFIG_save(void)
+{
+	uint8 image[EEPROM_SLOT_MAX_PAYLOAD];
+	uint8 size = CONFIG_buildImage(image);
+
+	return EEPROM_SLOT_store(&g_config_record, image, size);
+}
+
+static uint8 CONFIG_buildImage(uint8 * image)
+{
+	uint8 size = 0;
+	uint8 key;
+
+	/* the whole table is rewritten so the record never depends on an older one */
+	for(key = 0; key < CONFIG_NUM_KEYS; key++)
+	{
+		image[size++] = key;
+		image[size++] = (uint8)g_config_values[key];
+		if(CONFIG_TYPE_UINT16 == g_config_keys[key].type)
+		{
+			image[size++] = (uint8)(g_config_values[key] >> 8);
+		}
+	}
+
+	return size;
+}
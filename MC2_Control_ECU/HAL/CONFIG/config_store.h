@@ -0,0 +1,73 @@
+ /******************************************************************************
+ *
+ * Module: CONFIG
+ *
+ * File Name: config_store.h
+ *
+ * Description: Header file for the key-value configuration store
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#ifndef CONFIG_STORE_H_
+#define CONFIG_STORE_H_
+
+#include "../../std_types.h"
+#include "../STORAGE/storage.h"
+#include "../../../COMMON/config_keys.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* A/B slots of the configuration record in the internal EEPROM */
+#define CONFIG_STORE_DEVICE       STORAGE_INTERNAL_EEPROM
+#define CONFIG_SLOT_A_ADDR        0x0200
+#define CONFIG_SLOT_B_ADDR        0x0220
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Size of a value in the EEPROM record */
+typedef enum
+{
+	CONFIG_TYPE_UINT8,
+	CONFIG_TYPE_UINT16
+}Config_Type;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Load the configuration record into the RAM table. Keys missing from the
+ * record or out of their range get the default value.
+ */
+void CONFIG_init(void);
+
+/*
+ * Description :
+ * Return the value of the key from the RAM table, 0 for an unknown key.
+ */
+uint16 CONFIG_get(uint8 key);
+
+/*
+ * Description :
+ * Change the value of the key and save the configuration record.
+ * Return ERROR if the key is unknown or the value is out of its range.
+ */
+uint8 CONFIG_set(uint8 key, uint16 value);
+
+/*
+ * Description :
+ * Check one slot (0 or 1) of the configuration record. A bad slot is rewritten
+ * in place from the RAM table and the other slot is left untouched, repaired
+ * tells if the rewrite succeeded.
+ * Return FALSE if the slot was bad.
+ */
+uint8 CONFIG_checkSlot(uint8 slot, uint8 * repaired);
+
+#endif /* CONFIG_STORE_H_ */
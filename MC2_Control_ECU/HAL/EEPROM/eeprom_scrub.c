@@ -0,0 +1,94 @@
+ /******************************************************************************
+ *
+ * Module: EEPROM Scrubber
+ *
+ * File Name: eeprom_scrub.c
+ *
+ * Description: Source file for the background integrity check of the EEPROM records
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#include "eeprom_scrub.h"
+#include "eeprom_store.h"
+#include "../CONFIG/config_store.h"
+#include "../STORAGE/storage.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Steps of one pass: every slot of the record store then the two configuration slots */
+#define SCRUB_CONFIG_FIRST_STEP   EEPROM_STORE_NUM_SLOTS
+#define SCRUB_NUM_STEPS           (EEPROM_STORE_NUM_SLOTS + 2)
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static uint8 g_scrub_step = 0;
+static EEPROM_SCRUB_Statistics_t g_scrub_stats = {0, 0, 0};
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Check the next record, one record per call: a slot of the record store or
+ * of the configuration record, at most 32 bytes read from its memory and a
+ * CRC over them. The slice is skipped while the memory has pending writes
+ * so it never waits for a write cycle. To be called while the system is idle.
+ * Return ERROR if the record is bad and could not be erased or rewritten.
+ */
+uint8 EEPROM_SCRUB_task(void)
+{
+	uint8 valid, repaired, failed;
+
+	/* a read during a write cycle would block for up to 10ms */
+	if(g_scrub_step < SCRUB_CONFIG_FIRST_STEP)
+	{
+		if(!STORAGE_isIdle(EEPROM_STORE_DEVICE))
+		{
+			return SUCCESS;
+		}
+		valid = EEPROM_STORE_checkSlot(g_scrub_step, &repaired);
+		failed = (!valid && EEPROM_STORE_isErasePending());
+	}
+	else
+	{
+		if(!STORAGE_isIdle(CONFIG_STORE_DEVICE))
+		{
+			return SUCCESS;
+		}
+		valid = CONFIG_checkSlot(g_scrub_step - SCRUB_CONFIG_FIRST_STEP, &repaired);
+		failed = (!valid && !repaired);
+	}
+
+	if(!valid)
+	{
+		g_scrub_stats.errors++;
+		if(repaired)
+		{
+			g_scrub_stats.repairs++;
+		}
+	}
+
+	if(++g_scrub_step >= SCRUB_NUM_STEPS)
+	{
+		g_scrub_step = 0;
+		g_scrub_stats.passes++;
+	}
+
+	return failed ? ERROR : SUCCESS;
+}
+
+/*
+ * Description :
+ * Copy the scrubber counters.
+ */
+void EEPROM_SCRUB_getStatistics(EEPROM_SCRUB_Statistics_t * stats)
+{
+	*stats = g_scrub_stats;
+}
@@ -0,0 +1,49 @@
+ /******************************************************************************
+ *
+ * Module: EEPROM Scrubber
+ *
+ * File Name: eeprom_scrub.h
+ *
+ * Description: Header file for the background integrity check of the EEPROM records
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#ifndef EEPROM_SCRUB_H_
+#define EEPROM_SCRUB_H_
+
+#include "../../std_types.h"
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef struct
+{
+	uint16 passes;    /* complete walks over all the records */
+	uint16 errors;    /* records found failing their CRC check */
+	uint16 repairs;   /* bad records restored from a redundant copy */
+}EEPROM_SCRUB_Statistics_t;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Check the next record, one record per call: a slot of the record store or
+ * of the configuration record, at most 32 bytes read from its memory and a
+ * CRC over them. The slice is skipped while the memory has pending writes
+ * so it never waits for a write cycle. To be called while the system is idle.
+ * Return ERROR if the record is bad and could not be erased or rewritten.
+ */
+uint8 EEPROM_SCRUB_task(void);
+
+/*
+ * Description :
+ * Copy the scrubber counters.
+ */
+void EEPROM_SCRUB_getStatistics(EEPROM_SCRUB_Statistics_t * stats);
+
+#endif /* EEPROM_SCRUB_H_ */
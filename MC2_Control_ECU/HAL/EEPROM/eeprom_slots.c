@@ -0,0 +1,208 @@
+ /******************************************************************************
+ *
+ * Module: EEPROM Slots
+ *
+ * File Name: eeprom_slots.c
+ *
+ * Description: Source file for the crash-consistent A/B slot records in EEPROM
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#include "eeprom_slots.h"
+#include "external_eeprom.h"
+#include <util/crc16.h>
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/*
+ * Calculate the CRC16 (CCITT) of the sequence number, size and payload of a slot image.
+ */
+static uint16 EEPROM_SLOT_crc(const uint8 * image);
+
+/*
+ * Seal the value with the sequence number and its CRC and write it to the slot.
+ */
+static uint8 EEPROM_SLOT_write(const EEPROM_SLOT_Record_t * record, uint8 slot, uint8 seq, const uint8 * data, uint8 size);
+
+/*
+ * Return TRUE if the slot image has a valid size and CRC.
+ */
+static uint8 EEPROM_SLOT_isValid(const EEPROM_SLOT_Record_t * record, const uint8 * image);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Read both slots once and select the newest one with a valid CRC.
+ * The payload and its size are copied to data and size.
+ * Return ERROR if none of the two slots is valid (never written or both torn).
+ */
+uint8 EEPROM_SLOT_load(EEPROM_SLOT_Record_t * record, uint8 * data, uint8 * size)
+{
+	uint8 image[2][EEPROM_SLOT_HEADER_SIZE + EEPROM_SLOT_MAX_PAYLOAD];
+	uint8 valid[2];
+	uint8 i;
+
+	record->active = EEPROM_SLOT_NONE;
+
+	for(i = 0; i < 2; i++)
+	{
+		valid[i] = FALSE;
+
+		if(STORAGE_read(record->device, record->slot_addr[i], image[i], EEPROM_SLOT_HEADER_SIZE + record->max_size) != STORAGE_OK)
+		{
+			continue;
+		}
+
+		valid[i] = EEPROM_SLOT_isValid(record, image[i]);
+	}
+
+	if(valid[0] && valid[1])
+	{
+		/* both are valid, the newest is the one ahead in sequence (wraps around at 255) */
+		record->active = ((uint8)(image[1][0] - image[0][0]) < 128) ? 1 : 0;
+	}
+	else if(valid[0] || valid[1])
+	{
+		record->active = valid[0] ? 0 : 1;
+	}
+	else
+	{
+		return ERROR;
+	}
+
+	record->seq = image[record->active][0];
+	*size = image[record->active][1];
+	for(i = 0; i < *size; i++)
+	{
+		data[i] = image[record->active][EEPROM_SLOT_HEADER_SIZE + i];
+	}
+
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Write the new value with the next sequence number to the inactive slot and
+ * make it the current one.
+ */
+uint8 EEPROM_SLOT_store(EEPROM_SLOT_Record_t * record, const uint8 * data, uint8 size)
+{
+	uint8 target;
+
+	/* the first store after an empty load goes to slot A */
+	target = (EEPROM_SLOT_NONE == record->active) ? 0 : (record->active ^ 1);
+
+	if(EEPROM_SLOT_write(record, target, record->seq + 1, data, size) != SUCCESS)
+	{
+		return ERROR;
+	}
+
+	record->active = target;
+	record->seq++;
+
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Re-read one slot (0 for A, 1 for B) and check its CRC.
+ * Return FALSE if the slot was written but does not hold a valid image,
+ * a slot that was never written is not an error.
+ */
+uint8 EEPROM_SLOT_check(EEPROM_SLOT_Record_t * record, uint8 slot)
+{
+	uint8 image[EEPROM_SLOT_HEADER_SIZE + EEPROM_SLOT_MAX_PAYLOAD];
+
+	if(STORAGE_read(record->device, record->slot_addr[slot], image, EEPROM_SLOT_HEADER_SIZE + record->max_size) != STORAGE_OK)
+	{
+		return FALSE;
+	}
+
+	/* an erased header means the slot was never used */
+	if((0xFF == image[0]) && (0xFF == image[1]))
+	{
+		return TRUE;
+	}
+
+	return EEPROM_SLOT_isValid(record, image);
+}
+
+/*
+ * Description :
+ * Write the current value again to one slot (0 for A, 1 for B) that failed its
+ * check, the other slot is left untouched. The active slot keeps its sequence
+ * number and the inactive one gets the previous number, so the active slot
+ * stays the newest one. If none of the slots was valid the slot becomes the
+ * active one.
+ */
+uint8 EEPROM_SLOT_rewrite(EEPROM_SLOT_Record_t * record, uint8 slot, const uint8 * data, uint8 size)
+{
+	if(EEPROM_SLOT_NONE == record->active)
+	{
+		if(EEPROM_SLOT_write(record, slot, record->seq + 1, data, size) != SUCCESS)
+		{
+			return ERROR;
+		}
+
+		record->active = slot;
+		record->seq++;
+
+		return SUCCESS;
+	}
+
+	/* an older sequence number for the inactive slot, a load still selects the active one */
+	return EEPROM_SLOT_write(record, slot, (slot == record->active) ? record->seq : (uint8)(record->seq - 1), data, size);
+}
+
+static uint8 EEPROM_SLOT_write(const EEPROM_SLOT_Record_t * record, uint8 slot, uint8 seq, const uint8 * data, uint8 size)
+{
+	uint8 image[EEPROM_SLOT_HEADER_SIZE + EEPROM_SLOT_MAX_PAYLOAD];
+	uint8 i;
+	uint16 crc;
+
+	if(size > record->max_size)
+	{
+		return ERROR;
+	}
+
+	image[0] = seq;
+	image[1] = size;
+	for(i = 0; i < size; i++)
+	{
+		image[EEPROM_SLOT_HEADER_SIZE + i] = data[i];
+	}
+	crc = EEPROM_SLOT_crc(image);
+	image[2] = (uint8)crc;
+	image[3] = (uint8)(crc >> 8);
+
+	return (STORAGE_write(record->device, record->slot_addr[slot], image, EEPROM_SLOT_HEADER_SIZE + size) == STORAGE_OK) ? SUCCESS : ERROR;
+}
+
+static uint8 EEPROM_SLOT_isValid(const EEPROM_SLOT_Record_t * record, const uint8 * image)
+{
+	/* image: [seq][size][crc low][crc high][payload] */
+	return ((image[1] <= record->max_size) &&
+			(EEPROM_SLOT_crc(image) == (image[2] | ((uint16)image[3] << 8))));
+}
+
+static uint16 EEPROM_SLOT_crc(const uint8 * image)
+{
+	uint16 crc = 0xFFFF;
+	uint8 i;
+
+	crc = _crc_ccitt_update(crc, image[0]);
+	crc = _crc_ccitt_update(crc, image[1]);
+	for(i = 0; i < image[1]; i++)
+	{
+		crc = _crc_ccitt_update(crc, image[EEPROM_SLOT_HEADER_SIZE + i]);
+	}
+
+	return crc;
+}
@@ -0,0 +1,87 @@
+ /******************************************************************************
+ *
+ * Module: EEPROM Slots
+ *
+ * File Name: eeprom_slots.h
+ *
+ * Description: Header file for the crash-consistent A/B slot records in EEPROM
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#ifndef EEPROM_SLOTS_H_
+#define EEPROM_SLOTS_H_
+
+#include "../../std_types.h"
+#include "../STORAGE/storage.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Slot header: sequence number, payload size and CRC16 of both + payload */
+#define EEPROM_SLOT_HEADER_SIZE   4
+
+/* Largest payload a slot record can hold */
+#define EEPROM_SLOT_MAX_PAYLOAD   28
+
+/* Value of the active slot index when none of the two slots holds a valid record */
+#define EEPROM_SLOT_NONE          0xFF
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*
+ * A record stored in two slots A and B of (EEPROM_SLOT_HEADER_SIZE + max_size) bytes.
+ * A new value is always written to the inactive slot with the next sequence number,
+ * so a reset during the write leaves the previous value intact in the other slot.
+ */
+typedef struct
+{
+	Storage_Device device;   /* memory holding the two slots */
+	uint16 slot_addr[2];   /* EEPROM address of slot A and slot B */
+	uint8 max_size;        /* payload capacity, up to EEPROM_SLOT_MAX_PAYLOAD */
+	uint8 active;          /* index of the slot holding the current value */
+	uint8 seq;             /* sequence number of the current value */
+}EEPROM_SLOT_Record_t;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Read both slots once and select the newest one with a valid CRC.
+ * The payload and its size are copied to data and size.
+ * Return ERROR if none of the two slots is valid (never written or both torn).
+ */
+uint8 EEPROM_SLOT_load(EEPROM_SLOT_Record_t * record, uint8 * data, uint8 * size);
+
+/*
+ * Description :
+ * Write the new value with the next sequence number to the inactive slot and
+ * make it the current one.
+ */
+uint8 EEPROM_SLOT_store(EEPROM_SLOT_Record_t * record, const uint8 * data, uint8 size);
+
+/*
+ * Description :
+ * Re-read one slot (0 for A, 1 for B) and check its CRC.
+ * Return FALSE if the slot was written but does not hold a valid image,
+ * a slot that was never written is not an error.
+ */
+uint8 EEPROM_SLOT_check(EEPROM_SLOT_Record_t * record, uint8 slot);
+
+/*
+ * Description :
+ * Write the current value again to one slot (0 for A, 1 for B) that failed its
+ * check, the other slot is left untouched. The active slot keeps its sequence
+ * number and the inactive one gets the previous number, so the active slot
+ * stays the newest one. If none of the slots was valid the slot becomes the
+ * active one.
+ */
+uint8 EEPROM_SLOT_rewrite(EEPROM_SLOT_Record_t * record, uint8 slot, const uint8 * data, uint8 size);
+
+#endif /* EEPROM_SLOTS_H_ */
@@ -0,0 +1,343 @@
+ /******************************************************************************
+ *
+ * Module: EEPROM Record Store
+ *
+ * File Name: eeprom_store.c
+ *
+ * Description: Source file for the wear-leveled log-structured record store in EEPROM
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#include "eeprom_store.h"
+#include <util/crc16.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Offsets inside a record: [key][size][seq low][seq high][crc low][crc high][payload] */
+#define RECORD_KEY        0
+#define RECORD_SIZE       1
+#define RECORD_SEQ        2
+#define RECORD_CRC        4
+
+#define SLOT_ADDRESS(slot)    (EEPROM_STORE_START_ADDR + ((uint16)(slot) * EEPROM_STORE_RECORD_SIZE))
+#define NEXT_SLOT(slot)       (((slot) + 1) % EEPROM_STORE_NUM_SLOTS)
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* slot of the current record of every key */
+static uint8 g_store_index[EEPROM_STORE_NUM_KEYS];
+
+/* next slot to write and sequence number of the last written record */
+static uint8 g_store_head = 0;
+static uint16 g_store_seq = 0;
+
+/* bit per key whose bad record could not be superseded by an empty one yet */
+static uint8 g_store_erase_pending = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/*
+ * Calculate the CRC16 (CCITT) of the record except the CRC field itself.
+ */
+static uint16 EEPROM_STORE_crc(const uint8 * record);
+
+/*
+ * Read the record of the slot, return TRUE if it is a valid record.
+ */
+static uint8 EEPROM_STORE_readSlot(uint8 slot, uint8 * record);
+
+/*
+ * Give the record the next sequence number, seal it with its CRC and write it to the slot.
+ */
+static uint8 EEPROM_STORE_writeSlot(uint8 slot, uint8 * record);
+
+/*
+ * Return the key whose current record is in the slot, EEPROM_STORE_NUM_KEYS if none.
+ */
+static uint8 EEPROM_STORE_getOwner(uint8 slot);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Build the RAM index with one sequential scan of the ring: for every key the
+ * slot of its newest valid record, and the slot following the newest record
+ * as the next one to write.
+ */
+void EEPROM_STORE_init(void)
+{
+	uint8 record[EEPROM_STORE_RECORD_SIZE];
+	uint16 key_seq[EEPROM_STORE_NUM_KEYS];
+	uint16 seq;
+	uint8 slot, key, found = FALSE;
+
+	for(key = 0; key < EEPROM_STORE_NUM_KEYS; key++)
+	{
+		g_store_index[key] = EEPROM_STORE_NO_SLOT;
+	}
+	g_store_head = 0;
+	g_store_seq = 0;
+
+	for(slot = 0; slot < EEPROM_STORE_NUM_SLOTS; slot++)
+	{
+		if(!EEPROM_STORE_readSlot(slot, record))
+		{
+			continue;
+		}
+
+		key = record[RECORD_KEY];
+		seq = record[RECORD_SEQ] | ((uint16)record[RECORD_SEQ + 1] << 8);
+
+		/*
+		 * All the valid records are written within one turn of the ring, so a
+		 * signed difference orders them even after the sequence number wraps
+		 */
+		if((EEPROM_STORE_NO_SLOT == g_store_index[key]) || ((sint16)(seq - key_seq[key]) > 0))
+		{
+			g_store_index[key] = slot;
+			key_seq[key] = seq;
+		}
+
+		if(!found || ((sint16)(seq - g_store_seq) > 0))
+		{
+			g_store_seq = seq;
+			g_store_head = NEXT_SLOT(slot);
+			found = TRUE;
+		}
+	}
+}
+
+/*
+ * Description :
+ * Read the current record of the key through the RAM index.
+ * Return ERROR if the key has no record, is erased or the record fails its CRC check.
+ */
+uint8 EEPROM_STORE_read(uint8 key, uint8 * data, uint8 * size)
+{
+	uint8 record[EEPROM_STORE_RECORD_SIZE];
+	uint8 i;
+
+	if((key >= EEPROM_STORE_NUM_KEYS) || (EEPROM_STORE_NO_SLOT == g_store_index[key]))
+	{
+		return ERROR;
+	}
+
+	/* an empty record marks an erased key */
+	if(!EEPROM_STORE_readSlot(g_store_index[key], record) || (0 == record[RECORD_SIZE]))
+	{
+		return ERROR;
+	}
+
+	*size = record[RECORD_SIZE];
+	for(i = 0; i < *size; i++)
+	{
+		data[i] = record[EEPROM_STORE_HEADER_SIZE + i];
+	}
+
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Append a new record of the key at the head of the ring. The previous record
+ * stays valid until the new one is written, superseded records are reused as
+ * the head goes around the ring and live records in its way are moved forward.
+ */
+uint8 EEPROM_STORE_write(uint8 key, const uint8 * data, uint8 size)
+{
+	uint8 record[EEPROM_STORE_RECORD_SIZE];
+	uint8 owner, free_slot, i;
+
+	if((key >= EEPROM_STORE_NUM_KEYS) || (size > EEPROM_STORE_MAX_PAYLOAD))
+	{
+		return ERROR;
+	}
+
+	/* never overwrite the current record of the same key, it is the fallback until the new one is written */
+	while(EEPROM_STORE_getOwner(g_store_head) == key)
+	{
+		g_store_head = NEXT_SLOT(g_store_head);
+	}
+
+	/* a live record of another key is in the way, move it to the first free slot ahead */
+	owner = EEPROM_STORE_getOwner(g_store_head);
+	if(owner < EEPROM_STORE_NUM_KEYS)
+	{
+		free_slot = NEXT_SLOT(g_store_head);
+		while(EEPROM_STORE_getOwner(free_slot) < EEPROM_STORE_NUM_KEYS)
+		{
+			free_slot = NEXT_SLOT(free_slot);
+		}
+
+		if(!EEPROM_STORE_readSlot(g_store_head, record))
+		{
+			/* the record went bad since the boot scan, there is nothing left to keep */
+			g_store_index[owner] = EEPROM_STORE_NO_SLOT;
+		}
+		else if(EEPROM_STORE_writeSlot(free_slot, record) != SUCCESS)
+		{
+			return ERROR;
+		}
+		else
+		{
+			g_store_index[owner] = free_slot;
+		}
+	}
+
+	record[RECORD_KEY] = key;
+	record[RECORD_SIZE] = size;
+	for(i = 0; i < size; i++)
+	{
+		record[EEPROM_STORE_HEADER_SIZE + i] = data[i];
+	}
+	for(; i < EEPROM_STORE_MAX_PAYLOAD; i++)
+	{
+		/* keep the unused bytes erased */
+		record[EEPROM_STORE_HEADER_SIZE + i] = 0xFF;
+	}
+
+	if(EEPROM_STORE_writeSlot(g_store_head, record) != SUCCESS)
+	{
+		return ERROR;
+	}
+
+	g_store_index[key] = g_store_head;
+	g_store_head = NEXT_SLOT(g_store_head);
+	g_store_erase_pending &= ~(1 << key);
+
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Erase the key by appending an empty record, it supersedes the older records
+ * of the key so they are not taken as its value again, not even after a reset.
+ */
+uint8 EEPROM_STORE_erase(uint8 key)
+{
+	return EEPROM_STORE_write(key, NULL_PTR, 0);
+}
+
+/*
+ * Description :
+ * Re-read the slot if it holds the current record of a key and check its CRC.
+ * The value of a bad current record is lost: the key is erased, so neither the
+ * RAM index nor the next boot scan falls back to an older, superseded record.
+ * repaired is always FALSE since the value itself can not be restored.
+ * Return FALSE if the slot holds a bad current record.
+ */
+uint8 EEPROM_STORE_checkSlot(uint8 slot, uint8 * repaired)
+{
+	uint8 record[EEPROM_STORE_RECORD_SIZE];
+	uint8 owner, key;
+
+	*repaired = FALSE;
+
+	/* retry the erases that could not be written, the keys read as missing meanwhile */
+	for(key = 0; key < EEPROM_STORE_NUM_KEYS; key++)
+	{
+		if(g_store_erase_pending & (1 << key))
+		{
+			EEPROM_STORE_erase(key);
+		}
+	}
+
+	/* superseded and free slots hold nothing to protect, they are rewritten when reused */
+	owner = EEPROM_STORE_getOwner(slot);
+	if((owner >= EEPROM_STORE_NUM_KEYS) || EEPROM_STORE_readSlot(slot, record))
+	{
+		return TRUE;
+	}
+
+	/*
+	 * the previous record of the key may be a revoked password, never fall back to it:
+	 * drop the bad record from the index and supersede every older record with an empty one
+	 */
+	g_store_index[owner] = EEPROM_STORE_NO_SLOT;
+	if(EEPROM_STORE_erase(owner) != SUCCESS)
+	{
+		g_store_erase_pending |= (1 << owner);
+	}
+
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Return TRUE while the erase of a bad record could not be written, the key
+ * reads as missing until EEPROM_STORE_checkSlot writes it.
+ */
+uint8 EEPROM_STORE_isErasePending(void)
+{
+	return (g_store_erase_pending != 0);
+}
+
+static uint16 EEPROM_STORE_crc(const uint8 * record)
+{
+	uint16 crc = 0xFFFF;
+	uint8 i;
+
+	for(i = 0; i < EEPROM_STORE_RECORD_SIZE; i++)
+	{
+		if((i != RECORD_CRC) && (i != (RECORD_CRC + 1)))
+		{
+			crc = _crc_ccitt_update(crc, record[i]);
+		}
+	}
+
+	return crc;
+}
+
+static uint8 EEPROM_STORE_readSlot(uint8 slot, uint8 * record)
+{
+	if(STORAGE_read(EEPROM_STORE_DEVICE, SLOT_ADDRESS(slot), record, EEPROM_STORE_RECORD_SIZE) != STORAGE_OK)
+	{
+		return FALSE;
+	}
+
+	/* an erased or torn slot fails one of these checks */
+	return ((record[RECORD_KEY] < EEPROM_STORE_NUM_KEYS) &&
+			(record[RECORD_SIZE] <= EEPROM_STORE_MAX_PAYLOAD) &&
+			(EEPROM_STORE_crc(record) == (record[RECORD_CRC] | ((uint16)record[RECORD_CRC + 1] << 8))));
+}
+
+static uint8 EEPROM_STORE_writeSlot(uint8 slot, uint8 * record)
+{
+	uint16 crc;
+
+	g_store_seq++;
+	record[RECORD_SEQ] = (uint8)g_store_seq;
+	record[RECORD_SEQ + 1] = (uint8)(g_store_seq >> 8);
+
+	crc = EEPROM_STORE_crc(record);
+	record[RECORD_CRC] = (uint8)crc;
+	record[RECORD_CRC + 1] = (uint8)(crc >> 8);
+
+	/* a record is exactly one page, an external eeprom programs it with a single page write */
+	return (STORAGE_write(EEPROM_STORE_DEVICE, SLOT_ADDRESS(slot), record, EEPROM_STORE_RECORD_SIZE) == STORAGE_OK) ? SUCCESS : ERROR;
+}
+
+static uint8 EEPROM_STORE_getOwner(uint8 slot)
+{
+	uint8 key;
+
+	for(key = 0; key < EEPROM_STORE_NUM_KEYS; key++)
+	{
+		if(g_store_index[key] == slot)
+		{
+			break;
+		}
+	}
+
+	return key;
+}
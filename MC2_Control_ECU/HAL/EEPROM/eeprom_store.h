@@ -0,0 +1,104 @@
+ /******************************************************************************
+ *
+ * Module: EEPROM Record Store
+ *
+ * File Name: eeprom_store.h
+ *
+ * Description: Header file for the wear-leveled log-structured record store in EEPROM
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#ifndef EEPROM_STORE_H_
+#define EEPROM_STORE_H_
+
+#include "../../std_types.h"
+#include "external_eeprom.h"
+#include "../STORAGE/storage.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Ring of record slots, one eeprom page per record, in the record partition of
+ * the external EEPROM. The ring spreads every change over all the slots of the
+ * partition, and the RAM index keeps a password check to a single slot read.
+ */
+#define EEPROM_STORE_DEVICE         STORAGE_EXTERNAL_EEPROM
+#define EEPROM_STORE_START_ADDR     STORAGE_RECORDS_PARTITION_ADDR
+#define EEPROM_STORE_NUM_SLOTS      32
+#define EEPROM_STORE_RECORD_SIZE    EEPROM_PAGE_SIZE
+
+/* Record header: key, payload size, 16-bit sequence number and CRC16 */
+#define EEPROM_STORE_HEADER_SIZE    6
+#define EEPROM_STORE_MAX_PAYLOAD    (EEPROM_STORE_RECORD_SIZE - EEPROM_STORE_HEADER_SIZE)
+
+/* Number of keys, every key has at most one live record in the ring */
+#define EEPROM_STORE_NUM_KEYS       4
+
+/* Index value of a key that has no record */
+#define EEPROM_STORE_NO_SLOT        0xFF
+
+#if ((EEPROM_STORE_NUM_SLOTS * EEPROM_STORE_RECORD_SIZE) > STORAGE_RECORDS_PARTITION_SIZE)
+#error "The ring does not fit in the record partition"
+#endif
+
+#if (EEPROM_STORE_NUM_KEYS >= EEPROM_STORE_NUM_SLOTS - 1)
+#error "The ring needs more slots than keys to always find a free slot"
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Build the RAM index with one sequential scan of the ring: for every key the
+ * slot of its newest valid record, and the slot following the newest record
+ * as the next one to write.
+ */
+void EEPROM_STORE_init(void);
+
+/*
+ * Description :
+ * Read the current record of the key through the RAM index.
+ * Return ERROR if the key has no record, is erased or the record fails its CRC check.
+ */
+uint8 EEPROM_STORE_read(uint8 key, uint8 * data, uint8 * size);
+
+/*
+ * Description :
+ * Append a new record of the key at the head of the ring. The previous record
+ * stays valid until the new one is written, superseded records are reused as
+ * the head goes around the ring and live records in its way are moved forward.
+ */
+uint8 EEPROM_STORE_write(uint8 key, const uint8 * data, uint8 size);
+
+/*
+ * Description :
+ * Erase the key by appending an empty record, it supersedes the older records
+ * of the key so they are not taken as its value again, not even after a reset.
+ */
+uint8 EEPROM_STORE_erase(uint8 key);
+
+/*
+ * Description :
+ * Re-read the slot if it holds the current record of a key and check its CRC.
+ * The value of a bad current record is lost: the key is erased, so neither the
+ * RAM index nor the next boot scan falls back to an older, superseded record.
+ * repaired is always FALSE since the value itself can not be restored. An
+ * erase that fails is retried on every call until it is written.
+ * Return FALSE if the slot holds a bad current record.
+ */
+uint8 EEPROM_STORE_checkSlot(uint8 slot, uint8 * repaired);
+
+/*
+ * Description :
+ * Return TRUE while the erase of a bad record could not be written, the key
+ * reads as missing until EEPROM_STORE_checkSlot writes it.
+ */
+uint8 EEPROM_STORE_isErasePending(void);
+
+#endif /* EEPROM_STORE_H_ */
@@ -0,0 +1,315 @@
+ /******************************************************************************
+ *
+ * Module: EEPROM Write-Behind Buffer
+ *
+ * File Name: eeprom_write_behind.c
+ *
+ * Description: Source file for the RAM write-behind buffer of the External EEPROM
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#include "eeprom_write_behind.h"
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+static EEPROM_WB_Entry_t g_wb_entries[EEPROM_WB_NUM_ENTRIES];
+
+/* the pending entries form a FIFO ring: head is the oldest, head + count - 1 the newest */
+static uint8 g_wb_head = 0;
+static uint8 g_wb_count = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/*
+ * Return the newest entry if it holds the page of u32addr, otherwise append a
+ * new entry to the ring. Return NULL_PTR if all the entries are used.
+ */
+static EEPROM_WB_Entry_t * EEPROM_WB_getEntry(uint32 u32addr);
+
+/*
+ * Write the next run of the oldest entry, release the entry once it has no pending bytes.
+ */
+static uint8 EEPROM_WB_writeOldest(void);
+
+/*
+ * Read the span of the pending bytes with one sequential read, drop the bytes
+ * that already hold their value in the EEPROM and join the remaining ones in a
+ * single run so the page costs one write cycle.
+ */
+static uint8 EEPROM_WB_dropUnchanged(EEPROM_WB_Entry_t * entry);
+
+/*
+ * Write the first run of contiguous pending bytes of the entry with one page write.
+ */
+static uint8 EEPROM_WB_writeRun(EEPROM_WB_Entry_t * entry);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Accept the data into the RAM buffer and return immediately, the bytes are
+ * written to the EEPROM later by EEPROM_WB_task. If the buffer is full the
+ * pending pages are flushed first.
+ */
+uint8 EEPROM_WB_write(uint32 u32addr, const uint8 *data, uint16 size)
+{
+	EEPROM_WB_Entry_t * entry;
+	uint8 offset;
+
+	while(size--)
+	{
+		entry = EEPROM_WB_getEntry(u32addr);
+		if(NULL_PTR == entry)
+		{
+			/* no free entry, make room by writing the pending pages */
+			if(EEPROM_WB_flush() != SUCCESS)
+			{
+				return ERROR;
+			}
+			entry = EEPROM_WB_getEntry(u32addr);
+		}
+
+		offset = u32addr & (EEPROM_PAGE_SIZE - 1);
+		entry->data[offset] = *data;
+		entry->dirty_mask |= (1u << offset);
+		entry->compared = FALSE;
+
+		u32addr++;
+		data++;
+	}
+
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Read the data from the EEPROM and replace the bytes still pending in the
+ * RAM buffer, so a read always returns the last written value.
+ */
+uint8 EEPROM_WB_read(uint32 u32addr, uint8 *data, uint16 size)
+{
+	uint8 k, offset;
+	uint16 byte;
+	EEPROM_WB_Entry_t * entry;
+
+	if(EEPROM_readBuffer(u32addr, data, size) != SUCCESS)
+	{
+		return ERROR;
+	}
+
+	/* oldest first, so a page buffered twice returns the bytes of the newest entry */
+	for(k = 0; k < g_wb_count; k++)
+	{
+		entry = &g_wb_entries[(g_wb_head + k) % EEPROM_WB_NUM_ENTRIES];
+
+		for(byte = 0; byte < size; byte++)
+		{
+			if(((u32addr + byte) & ~(EEPROM_PAGE_SIZE - 1)) == entry->page_addr)
+			{
+				offset = (u32addr + byte) & (EEPROM_PAGE_SIZE - 1);
+				if(entry->dirty_mask & (1u << offset))
+				{
+					data[byte] = entry->data[offset];
+				}
+			}
+		}
+	}
+
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Background task: if the EEPROM finished its previous write cycle, write the
+ * next run of pending bytes with a single page write. Never waits on the EEPROM.
+ * The pages are written in the order they were buffered.
+ */
+void EEPROM_WB_task(void)
+{
+	/* the device does not answer while it is programming the last page */
+	if(g_wb_count && EEPROM_isReady())
+	{
+		EEPROM_WB_writeOldest();
+	}
+}
+
+/*
+ * Description :
+ * Write all the pending bytes to the EEPROM and wait for the last write cycle.
+ * Used before long blocking operations, so nothing stays pending during them.
+ */
+uint8 EEPROM_WB_flush(void)
+{
+	while(g_wb_count)
+	{
+		if(EEPROM_WB_writeOldest() != SUCCESS)
+		{
+			return ERROR;
+		}
+	}
+
+	return EEPROM_waitReady();
+}
+
+/*
+ * Description :
+ * Return TRUE if no bytes are waiting to be written to the EEPROM.
+ */
+uint8 EEPROM_WB_isEmpty(void)
+{
+	return (0 == g_wb_count);
+}
+
+static EEPROM_WB_Entry_t * EEPROM_WB_getEntry(uint32 u32addr)
+{
+	uint32 page_addr = u32addr & ~(EEPROM_PAGE_SIZE - 1);
+	EEPROM_WB_Entry_t * entry;
+
+	if(g_wb_count)
+	{
+		/*
+		 * coalesce only with the newest entry: merging into an older one would
+		 * write these bytes before the pages buffered after it
+		 */
+		entry = &g_wb_entries[(g_wb_head + g_wb_count - 1) % EEPROM_WB_NUM_ENTRIES];
+		if(entry->page_addr == page_addr)
+		{
+			return entry;
+		}
+	}
+
+	if(EEPROM_WB_NUM_ENTRIES == g_wb_count)
+	{
+		return NULL_PTR;
+	}
+
+	entry = &g_wb_entries[(g_wb_head + g_wb_count) % EEPROM_WB_NUM_ENTRIES];
+	entry->page_addr = page_addr;
+	entry->dirty_mask = 0;
+	g_wb_count++;
+
+	return entry;
+}
+
+static uint8 EEPROM_WB_writeOldest(void)
+{
+	EEPROM_WB_Entry_t * entry = &g_wb_entries[g_wb_head];
+
+	if(entry->dirty_mask)
+	{
+		if(EEPROM_WB_writeRun(entry) != SUCCESS)
+		{
+			return ERROR;
+		}
+	}
+
+	if(!entry->dirty_mask)
+	{
+		g_wb_head = (g_wb_head + 1) % EEPROM_WB_NUM_ENTRIES;
+		g_wb_count--;
+	}
+
+	return SUCCESS;
+}
+
+static uint8 EEPROM_WB_dropUnchanged(EEPROM_WB_Entry_t * entry)
+{
+	uint8 current[EEPROM_PAGE_SIZE];
+	uint8 first = 0, last = EEPROM_PAGE_SIZE - 1, i;
+
+	while(!(entry->dirty_mask & (1u << first)))
+	{
+		first++;
+	}
+	while(!(entry->dirty_mask & (1u << last)))
+	{
+		last--;
+	}
+
+	if(EEPROM_readBuffer(entry->page_addr + first, &current[first], last - first + 1) != SUCCESS)
+	{
+		return ERROR;
+	}
+
+	for(i = first; i <= last; i++)
+	{
+		if(!(entry->dirty_mask & (1u << i)))
+		{
+			/* take the current value of a gap byte, so the changed bytes around it can still share a page write */
+			entry->data[i] = current[i];
+		}
+		else if(current[i] == entry->data[i])
+		{
+			entry->dirty_mask &= ~(1u << i);
+		}
+	}
+
+	/* pending bytes that survived the compare are written as one run, gaps included */
+	if(entry->dirty_mask)
+	{
+		first = 0;
+		last = EEPROM_PAGE_SIZE - 1;
+		while(!(entry->dirty_mask & (1u << first)))
+		{
+			first++;
+		}
+		while(!(entry->dirty_mask & (1u << last)))
+		{
+			last--;
+		}
+		entry->dirty_mask = (uint16)(((1ul << (last - first + 1)) - 1) << first);
+	}
+
+	entry->compared = TRUE;
+
+	return SUCCESS;
+}
+
+static uint8 EEPROM_WB_writeRun(EEPROM_WB_Entry_t * entry)
+{
+	uint8 first = 0, count = 0;
+	uint16 run_mask;
+
+	/* a read costs far less than a write cycle, only the bytes that differ are programmed */
+	if(!entry->compared)
+	{
+		if(EEPROM_WB_dropUnchanged(entry) != SUCCESS)
+		{
+			return ERROR;
+		}
+
+		if(!entry->dirty_mask)
+		{
+			/* the page already holds the data */
+			return SUCCESS;
+		}
+	}
+
+	/* find the first pending byte then the length of its run */
+	while(!(entry->dirty_mask & (1u << first)))
+	{
+		first++;
+	}
+	while(((first + count) < EEPROM_PAGE_SIZE) && (entry->dirty_mask & (1u << (first + count))))
+	{
+		count++;
+	}
+
+	if(EEPROM_writePage(entry->page_addr + first, &entry->data[first], count) != SUCCESS)
+	{
+		/* keep the bytes pending, they are retried on the next call */
+		return ERROR;
+	}
+
+	run_mask = (uint16)(((1ul << count) - 1) << first);
+	entry->dirty_mask &= ~run_mask;
+
+	return SUCCESS;
+}
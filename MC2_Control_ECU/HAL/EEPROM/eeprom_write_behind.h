@@ -0,0 +1,83 @@
+ /******************************************************************************
+ *
+ * Module: EEPROM Write-Behind Buffer
+ *
+ * File Name: eeprom_write_behind.h
+ *
+ * Description: Header file for the RAM write-behind buffer of the External EEPROM
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#ifndef EEPROM_WRITE_BEHIND_H_
+#define EEPROM_WRITE_BEHIND_H_
+
+#include "../../std_types.h"
+#include "external_eeprom.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Number of EEPROM pages that can be pending in RAM at the same time */
+#define EEPROM_WB_NUM_ENTRIES     4
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*
+ * A page of the EEPROM waiting to be written, bit i of dirty_mask marks data[i] as pending.
+ * Before the first page write the pending bytes are compared with the EEPROM and the
+ * unchanged ones are dropped, compared is cleared when new bytes are buffered.
+ */
+typedef struct
+{
+	uint32 page_addr;
+	uint16 dirty_mask;
+	uint8 compared;
+	uint8 data[EEPROM_PAGE_SIZE];
+}EEPROM_WB_Entry_t;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Accept the data into the RAM buffer and return immediately, the bytes are
+ * written to the EEPROM later by EEPROM_WB_task. If the buffer is full the
+ * pending pages are flushed first.
+ */
+uint8 EEPROM_WB_write(uint32 u32addr, const uint8 *data, uint16 size);
+
+/*
+ * Description :
+ * Read the data from the EEPROM and replace the bytes still pending in the
+ * RAM buffer, so a read always returns the last written value.
+ */
+uint8 EEPROM_WB_read(uint32 u32addr, uint8 *data, uint16 size);
+
+/*
+ * Description :
+ * Background task: if the EEPROM finished its previous write cycle, write the
+ * next run of pending bytes with a single page write. Never waits on the EEPROM.
+ * The pages are written in the order they were buffered.
+ */
+void EEPROM_WB_task(void);
+
+/*
+ * Description :
+ * Write all the pending bytes to the EEPROM and wait for the last write cycle.
+ * Used before long blocking operations, so nothing stays pending during them.
+ */
+uint8 EEPROM_WB_flush(void);
+
+/*
+ * Description :
+ * Return TRUE if no bytes are waiting to be written to the EEPROM.
+ */
+uint8 EEPROM_WB_isEmpty(void);
+
+#endif /* EEPROM_WRITE_BEHIND_H_ */
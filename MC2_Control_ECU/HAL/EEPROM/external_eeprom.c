@@ -11,72 +11,442 @@
  *******************************************************************************/
 #include "external_eeprom.h"
 #include "../../MCAL/TWI/twi.h"
+#include <util/delay.h>
 
-uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data)
+/*******************************************************************************
+ *                           Configurations                                    *
+ *******************************************************************************/
+
+/*
+ * Devices mapped one after the other in the linear address space,
+ * e.g. two 24C256 with A0 pin low and high:
+ * {0xA0, 32768UL, 64, EEPROM_TWO_BYTES_ADDRESS},
+ * {0xA2, 32768UL, 64, EEPROM_TWO_BYTES_ADDRESS},
+ */
+static const EEPROM_Device_t g_eeprom_devices[EEPROM_NUM_DEVICES] =
 {
-	/* Send the Start Bit */
-    TWI_start();
-    if (TWI_getStatus() != TWI_START)
-        return ERROR;
-		
-    /* Send the device address, we need to get A8 A9 A10 address bits from the
-     * memory location address and R/W=0 (write) */
-    TWI_writeByte((uint8)(0xA0 | ((u16addr & 0x0700)>>7)));
-    if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
-        return ERROR; 
-		 
-    /* Send the required memory location address */
-    TWI_writeByte((uint8)(u16addr));
-    if (TWI_getStatus() != TWI_MT_DATA_ACK)
-        return ERROR;
-		
-    /* write byte to eeprom */
-    TWI_writeByte(u8data);
-    if (TWI_getStatus() != TWI_MT_DATA_ACK)
-        return ERROR;
-
-    /* Send the Stop Bit */
-    TWI_stop();
-	
-    return SUCCESS;
-}
-
-uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data)
+	{0xA0, 2048UL, 16, EEPROM_ONE_BYTE_ADDRESS}   /* 24C16 */
+};
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* device of the last write, the one to poll for the end of its write cycle */
+static const EEPROM_Device_t * g_eeprom_lastDevice = &g_eeprom_devices[0];
+
+static EEPROM_Statistics_t g_eeprom_stats = {0, 0, 0};
+
+/* a write cycle may still be running, it may also be one started before a reset */
+static uint8 g_eeprom_writePending = TRUE;
+
+/* TWI status of the last failed attempt, used to choose the recovery action */
+static uint8 g_eeprom_lastStatus;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/*
+ * Find the device holding the linear address and the offset of the address
+ * inside it. Return NULL_PTR if the address is beyond the last device.
+ */
+static const EEPROM_Device_t * EEPROM_getDevice(uint32 u32addr, uint32 *offset);
+
+/*
+ * Run a single write (read = FALSE) or sequential read (read = TRUE) transfer
+ * of size bytes starting at offset inside the device, a write must not cross
+ * a page boundary.
+ */
+static uint8 EEPROM_transferOnce(const EEPROM_Device_t *device, uint32 offset, uint8 *data, uint16 size, uint8 read);
+
+/*
+ * Run the transfer and repeat it up to EEPROM_MAX_RETRIES times on failure.
+ */
+static uint8 EEPROM_transfer(const EEPROM_Device_t *device, uint32 offset, uint8 *data, uint16 size, uint8 read);
+
+/*
+ * Return the device address (R/W=0) selecting the offset, one byte address
+ * devices take the address bits above 8 in the device address.
+ */
+static uint8 EEPROM_getDeviceAddress(const EEPROM_Device_t *device, uint32 offset);
+
+/*
+ * Send the start bit, the device address with R/W=0 then the memory location address.
+ */
+static uint8 EEPROM_selectAddress(const EEPROM_Device_t *device, uint32 offset);
+
+/*
+ * Record the status of the failed attempt and release the bus with a stop bit,
+ * so a failing transfer never leaves the bus held. Always returns ERROR.
+ */
+static uint8 EEPROM_abort(void);
+
+/*
+ * Prepare the bus for the next attempt according to the failure cause:
+ * timeouts and bus errors need the bus recovery, a NACK means the device
+ * is still busy in its internal write cycle.
+ */
+static void EEPROM_handleFailure(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+uint8 EEPROM_writeByte(uint32 u32addr, uint8 u8data)
+{
+	return EEPROM_writePage(u32addr, &u8data, 1);
+}
+
+uint8 EEPROM_readByte(uint32 u32addr, uint8 *u8data)
+{
+	return EEPROM_readBuffer(u32addr, u8data, 1);
+}
+
+/*
+ * Description :
+ * Write bytes inside one page of a device in one transfer. The function returns
+ * once the data is sent, the device then needs EEPROM_WRITE_CYCLE_MS to program
+ * it (check it with EEPROM_isReady). The next transfer waits for it first.
+ */
+uint8 EEPROM_writePage(uint32 u32addr, const uint8 *data, uint8 size)
+{
+	uint32 offset;
+	const EEPROM_Device_t *device = EEPROM_getDevice(u32addr, &offset);
+
+	if((NULL_PTR == device) || (size == 0) ||
+			(((offset & (device->page_size - 1)) + size) > device->page_size))
+	{
+		return ERROR;
+	}
+
+	/* the data is only sent, the cast is safe */
+	return EEPROM_transfer(device, offset, (uint8 *)data, size, FALSE);
+}
+
+/*
+ * Description :
+ * Write any number of bytes, the data is split at the page and device boundaries
+ * and the function waits for the write cycle of each page before sending the next one.
+ */
+uint8 EEPROM_writeBuffer(uint32 u32addr, const uint8 *data, uint16 size)
+{
+	uint32 offset;
+	const EEPROM_Device_t *device;
+	uint8 chunk;
+
+	while(size)
+	{
+		device = EEPROM_getDevice(u32addr, &offset);
+		if(NULL_PTR == device)
+		{
+			return ERROR;
+		}
+
+		/* bytes left till the end of the current page, pages never cross the device end */
+		chunk = device->page_size - (offset & (device->page_size - 1));
+		if(chunk > size)
+		{
+			chunk = (uint8)size;
+		}
+
+		if(EEPROM_writePage(u32addr, data, chunk) != SUCCESS)
+		{
+			return ERROR;
+		}
+
+		u32addr += chunk;
+		data += chunk;
+		size -= chunk;
+	}
+
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Read any number of bytes, with one sequential read transfer per device.
+ */
+uint8 EEPROM_readBuffer(uint32 u32addr, uint8 *data, uint16 size)
+{
+	uint32 offset;
+	const EEPROM_Device_t *device;
+	uint16 chunk;
+
+	while(size)
+	{
+		device = EEPROM_getDevice(u32addr, &offset);
+		if(NULL_PTR == device)
+		{
+			return ERROR;
+		}
+
+		/* the device address counter rolls over at the device end, split the read there */
+		chunk = ((device->size - offset) < size) ? (uint16)(device->size - offset) : size;
+
+		if(EEPROM_transfer(device, offset, data, chunk, TRUE) != SUCCESS)
+		{
+			return ERROR;
+		}
+
+		u32addr += chunk;
+		data += chunk;
+		size -= chunk;
+	}
+
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Return the size of the linear address space made of all the devices.
+ */
+uint32 EEPROM_getSize(void)
+{
+	uint32 size = 0;
+	uint8 i;
+
+	for(i = 0; i < EEPROM_NUM_DEVICES; i++)
+	{
+		size += g_eeprom_devices[i].size;
+	}
+
+	return size;
+}
+
+/*
+ * Description :
+ * Acknowledge polling: return TRUE if the last written device answers its
+ * address, which means its internal write cycle is finished, FALSE otherwise.
+ * Without a write since the last positive poll it returns TRUE at once.
+ */
+uint8 EEPROM_isReady(void)
+{
+	uint8 ready;
+
+	if(!g_eeprom_writePending)
+	{
+		return TRUE;
+	}
+
+	TWI_start();
+	if(TWI_getStatus() != TWI_START)
+	{
+		EEPROM_abort();
+		return FALSE;
+	}
+
+	TWI_writeByte(g_eeprom_lastDevice->device_address);
+	ready = (TWI_getStatus() == TWI_MT_SLA_W_ACK) ? TRUE : FALSE;
+
+	TWI_stop();
+
+	if(ready)
+	{
+		g_eeprom_writePending = FALSE;
+	}
+	return ready;
+}
+
+/*
+ * Description :
+ * Wait for the last written device to finish its internal write cycle,
+ * return ERROR if it is still busy after EEPROM_WRITE_CYCLE_MS.
+ */
+uint8 EEPROM_waitReady(void)
+{
+	uint8 polls;
+
+	/* poll every 100us */
+	for(polls = 0; polls < (EEPROM_WRITE_CYCLE_MS * 10); polls++)
+	{
+		if(EEPROM_isReady())
+		{
+			return SUCCESS;
+		}
+		_delay_us(100);
+	}
+
+	return ERROR;
+}
+
+void EEPROM_getStatistics(EEPROM_Statistics_t *stats)
+{
+	*stats = g_eeprom_stats;
+}
+
+static const EEPROM_Device_t * EEPROM_getDevice(uint32 u32addr, uint32 *offset)
+{
+	uint8 i;
+
+	for(i = 0; i < EEPROM_NUM_DEVICES; i++)
+	{
+		if(u32addr < g_eeprom_devices[i].size)
+		{
+			*offset = u32addr;
+			return &g_eeprom_devices[i];
+		}
+		u32addr -= g_eeprom_devices[i].size;
+	}
+
+	return NULL_PTR;
+}
+
+static uint8 EEPROM_transfer(const EEPROM_Device_t *device, uint32 offset, uint8 *data, uint16 size, uint8 read)
+{
+	uint8 attempt;
+	uint8 status;
+
+	for(attempt = 0; attempt <= EEPROM_MAX_RETRIES; attempt++)
+	{
+		if(attempt)
+		{
+			g_eeprom_stats.retries++;
+		}
+
+		/*
+		 * The devices do not answer during the write cycle, wait for its end first
+		 * so a busy device is not taken for a failing one. If it is still busy
+		 * after EEPROM_WRITE_CYCLE_MS the NACK below is a real error.
+		 */
+		EEPROM_waitReady();
+
+		status = EEPROM_transferOnce(device, offset, data, size, read);
+		if(!read)
+		{
+			/* the device programs the bytes it acknowledged once the stop bit is sent */
+			g_eeprom_lastDevice = device;
+			g_eeprom_writePending = TRUE;
+		}
+
+		if(SUCCESS == status)
+		{
+			return SUCCESS;
+		}
+
+		EEPROM_handleFailure();
+	}
+
+	g_eeprom_stats.failures++;
+	return ERROR;
+}
+
+static uint8 EEPROM_getDeviceAddress(const EEPROM_Device_t *device, uint32 offset)
+{
+	if(EEPROM_ONE_BYTE_ADDRESS == device->address_mode)
+	{
+		/* we need to get A8 A9 A10 address bits from the memory location address */
+		return (uint8)(device->device_address | ((offset & 0x0700)>>7));
+	}
+
+	return device->device_address;
+}
+
+static uint8 EEPROM_selectAddress(const EEPROM_Device_t *device, uint32 offset)
 {
 	/* Send the Start Bit */
-    TWI_start();
-    if (TWI_getStatus() != TWI_START)
-        return ERROR;
-		
-    /* Send the device address, we need to get A8 A9 A10 address bits from the
-     * memory location address and R/W=0 (write) */
-    TWI_writeByte((uint8)((0xA0) | ((u16addr & 0x0700)>>7)));
-    if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
-        return ERROR;
-		
-    /* Send the required memory location address */
-    TWI_writeByte((uint8)(u16addr));
-    if (TWI_getStatus() != TWI_MT_DATA_ACK)
-        return ERROR;
-		
-    /* Send the Repeated Start Bit */
-    TWI_start();
-    if (TWI_getStatus() != TWI_REP_START)
-        return ERROR;
-		
-    /* Send the device address, we need to get A8 A9 A10 address bits from the
-     * memory location address and R/W=1 (Read) */
-    TWI_writeByte((uint8)((0xA0) | ((u16addr & 0x0700)>>7) | 1));
-    if (TWI_getStatus() != TWI_MT_SLA_R_ACK)
-        return ERROR;
-
-    /* Read Byte from Memory without send ACK */
-    *u8data = TWI_readByteWithNACK();
-    if (TWI_getStatus() != TWI_MR_DATA_NACK)
-        return ERROR;
-
-    /* Send the Stop Bit */
-    TWI_stop();
-
-    return SUCCESS;
+	TWI_start();
+	if (TWI_getStatus() != TWI_START)
+		return EEPROM_abort();
+
+	/* Send the device address and R/W=0 (write) */
+	TWI_writeByte(EEPROM_getDeviceAddress(device, offset));
+	if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
+		return EEPROM_abort();
+
+	/* Send the high byte of the memory location address for the large devices */
+	if(EEPROM_TWO_BYTES_ADDRESS == device->address_mode)
+	{
+		TWI_writeByte((uint8)(offset >> 8));
+		if (TWI_getStatus() != TWI_MT_DATA_ACK)
+			return EEPROM_abort();
+	}
+
+	/* Send the required memory location address */
+	TWI_writeByte((uint8)(offset));
+	if (TWI_getStatus() != TWI_MT_DATA_ACK)
+		return EEPROM_abort();
+
+	return SUCCESS;
+}
+
+static uint8 EEPROM_transferOnce(const EEPROM_Device_t *device, uint32 offset, uint8 *data, uint16 size, uint8 read)
+{
+	uint16 i;
+
+	if(EEPROM_selectAddress(device, offset) != SUCCESS)
+		return ERROR;
+
+	if(!read)
+	{
+		/* write bytes to eeprom, the device increments the address inside the page */
+		for(i = 0; i < size; i++)
+		{
+			TWI_writeByte(data[i]);
+			if (TWI_getStatus() != TWI_MT_DATA_ACK)
+				return EEPROM_abort();
+		}
+	}
+	else
+	{
+		/* Send the Repeated Start Bit */
+		TWI_start();
+		if (TWI_getStatus() != TWI_REP_START)
+			return EEPROM_abort();
+
+		/* Send the same device address with R/W=1 (Read) */
+		TWI_writeByte(EEPROM_getDeviceAddress(device, offset) | 1);
+		if (TWI_getStatus() != TWI_MT_SLA_R_ACK)
+			return EEPROM_abort();
+
+		/* Read Bytes from Memory with ACK, the last one without ACK */
+		for(i = 0; i < (size - 1); i++)
+		{
+			data[i] = TWI_readByteWithACK();
+			if (TWI_getStatus() != TWI_MR_DATA_ACK)
+				return EEPROM_abort();
+		}
+
+		data[i] = TWI_readByteWithNACK();
+		if (TWI_getStatus() != TWI_MR_DATA_NACK)
+			return EEPROM_abort();
+	}
+
+	/* Send the Stop Bit */
+	TWI_stop();
+
+	return SUCCESS;
+}
+
+static uint8 EEPROM_abort(void)
+{
+	g_eeprom_lastStatus = TWI_getStatus();
+
+	/* Release the bus, after an arbitration loss this only resets the TWI module state */
+	TWI_stop();
+
+	return ERROR;
+}
+
+static void EEPROM_handleFailure(void)
+{
+	switch(g_eeprom_lastStatus)
+	{
+	case TWI_TIMEOUT:
+	case TWI_BUS_ERROR:
+		/* a slave may be holding SDA low, clock it free and restart the TWI module */
+		TWI_recoverBus();
+		g_eeprom_stats.bus_recoveries++;
+		break;
+
+	case TWI_MT_SLA_W_NACK:
+	case TWI_MT_SLA_R_NACK:
+		/* the write cycle was awaited before the transfer, give the device a moment to answer again */
+		_delay_ms(EEPROM_RETRY_DELAY_MS);
+		break;
+
+	default:
+		/* arbitration lost or data NACK, the stop bit is enough to retry */
+		break;
+	}
 }
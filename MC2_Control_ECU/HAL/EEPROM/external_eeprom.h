@@ -22,11 +22,104 @@
 #define ERROR 0
 #define SUCCESS 1
 
+/* Number of devices on the bus, described in the device table of external_eeprom.c */
+#define EEPROM_NUM_DEVICES        1
+
+/*
+ * Smallest page size of the configured devices, the page sizes of all of them
+ * (16 to 128 bytes) are multiples of it so the upper layers align their records
+ * to it and never cross a page or a device boundary.
+ */
+#define EEPROM_PAGE_SIZE          16
+#define EEPROM_WRITE_CYCLE_MS     10
+
+/* Number of times a failed transfer is repeated before giving up */
+#define EEPROM_MAX_RETRIES        3
+
+/* Wait before repeating a transfer NACKed by the device once its write cycle is over */
+#define EEPROM_RETRY_DELAY_MS     2
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Addressing scheme of the memory location inside a device */
+typedef enum
+{
+	EEPROM_ONE_BYTE_ADDRESS,   /* 24C01 to 24C16: A8..A10 are sent in the device address */
+	EEPROM_TWO_BYTES_ADDRESS   /* 24C32 to 24C512: high byte then low byte of the address */
+}EEPROM_AddressMode;
+
+/* Description of one EEPROM device, the devices are mapped one after the other */
+typedef struct
+{
+	uint8 device_address;      /* 0xA0 with the A2..A0 pins of the device */
+	uint32 size;               /* device size in bytes */
+	uint8 page_size;           /* page size in bytes */
+	EEPROM_AddressMode address_mode;
+}EEPROM_Device_t;
+
+/* Error counters of the EEPROM transfers, kept since power up */
+typedef struct
+{
+	uint16 retries;         /* transfers repeated after a failed attempt */
+	uint16 failures;        /* transfers that still failed after EEPROM_MAX_RETRIES */
+	uint16 bus_recoveries;  /* times the bus was clocked free after a timeout or bus error */
+}EEPROM_Statistics_t;
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
-uint8 EEPROM_writeByte(uint16 u16addr,uint8 u8data);
-uint8 EEPROM_readByte(uint16 u16addr,uint8 *u8data);
+uint8 EEPROM_writeByte(uint32 u32addr,uint8 u8data);
+uint8 EEPROM_readByte(uint32 u32addr,uint8 *u8data);
+
+/*
+ * Description :
+ * Write bytes inside one page of a device in one transfer. The function returns
+ * once the data is sent, the device then needs EEPROM_WRITE_CYCLE_MS to program
+ * it (check it with EEPROM_isReady). The next transfer waits for it first.
+ */
+uint8 EEPROM_writePage(uint32 u32addr, const uint8 *data, uint8 size);
+
+/*
+ * Description :
+ * Write any number of bytes, the data is split at the page and device boundaries
+ * and the function waits for the write cycle of each page before sending the next one.
+ */
+uint8 EEPROM_writeBuffer(uint32 u32addr, const uint8 *data, uint16 size);
+
+/*
+ * Description :
+ * Read any number of bytes, with one sequential read transfer per device.
+ */
+uint8 EEPROM_readBuffer(uint32 u32addr, uint8 *data, uint16 size);
+
+/*
+ * Description :
+ * Return the size of the linear address space made of all the devices.
+ */
+uint32 EEPROM_getSize(void);
+
+/*
+ * Description :
+ * Acknowledge polling: return TRUE if the last written device answers its
+ * address, which means its internal write cycle is finished, FALSE otherwise.
+ * Without a write since the last positive poll it returns TRUE at once.
+ */
+uint8 EEPROM_isReady(void);
+
+/*
+ * Description :
+ * Wait for the last written device to finish its internal write cycle,
+ * return ERROR if it is still busy after EEPROM_WRITE_CYCLE_MS.
+ */
+uint8 EEPROM_waitReady(void);
+
+/*
+ * Description :
+ * Copy the error counters of the EEPROM transfers to the given structure.
+ */
+void EEPROM_getStatistics(EEPROM_Statistics_t *stats);
  
 #endif /* EXTERNAL_EEPROM_H_ */
@@ -0,0 +1,175 @@
+ /******************************************************************************
+ *
+ * Module: STORAGE
+ *
+ * File Name: storage.c
+ *
+ * Description: Source file for the common interface of the non-volatile memories
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#include "storage.h"
+#include "../../MCAL/EEPROM/internal_eeprom.h"
+#include "../EEPROM/external_eeprom.h"
+#include "../EEPROM/eeprom_write_behind.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Bytes of erased value written at once by STORAGE_erase */
+#define STORAGE_ERASE_CHUNK       EEPROM_PAGE_SIZE
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Read size bytes starting at address, pending writes are already visible.
+ */
+Storage_Status STORAGE_read(Storage_Device device, uint32 address, uint8 *data, uint16 size)
+{
+	if((address + size) > STORAGE_getSize(device))
+	{
+		return STORAGE_INVALID_RANGE;
+	}
+
+	switch(device)
+	{
+	case STORAGE_INTERNAL_EEPROM:
+		IEEPROM_read((uint16)address, data, size);
+		return STORAGE_OK;
+
+	case STORAGE_EXTERNAL_EEPROM:
+		return (EEPROM_WB_read(address, data, size) == SUCCESS) ? STORAGE_OK : STORAGE_DEVICE_ERROR;
+	}
+
+	return STORAGE_INVALID_RANGE;
+}
+
+/*
+ * Description :
+ * Write size bytes starting at address. Both memories accept the data in RAM
+ * and program it in the background, a later read returns the new data.
+ */
+Storage_Status STORAGE_write(Storage_Device device, uint32 address, const uint8 *data, uint16 size)
+{
+	if((address + size) > STORAGE_getSize(device))
+	{
+		return STORAGE_INVALID_RANGE;
+	}
+
+	switch(device)
+	{
+	case STORAGE_INTERNAL_EEPROM:
+		IEEPROM_write((uint16)address, data, size);
+		return STORAGE_OK;
+
+	case STORAGE_EXTERNAL_EEPROM:
+		return (EEPROM_WB_write(address, data, size) == SUCCESS) ? STORAGE_OK : STORAGE_DEVICE_ERROR;
+	}
+
+	return STORAGE_INVALID_RANGE;
+}
+
+/*
+ * Description :
+ * Set size bytes starting at address to the erased value 0xFF.
+ */
+Storage_Status STORAGE_erase(Storage_Device device, uint32 address, uint16 size)
+{
+	uint8 erased[STORAGE_ERASE_CHUNK];
+	uint8 i, chunk;
+	Storage_Status status;
+
+	for(i = 0; i < STORAGE_ERASE_CHUNK; i++)
+	{
+		erased[i] = 0xFF;
+	}
+
+	while(size)
+	{
+		chunk = (size > STORAGE_ERASE_CHUNK) ? STORAGE_ERASE_CHUNK : (uint8)size;
+
+		status = STORAGE_write(device, address, erased, chunk);
+		if(status != STORAGE_OK)
+		{
+			return status;
+		}
+
+		address += chunk;
+		size -= chunk;
+	}
+
+	return STORAGE_OK;
+}
+
+/*
+ * Description :
+ * Return the size of the memory in bytes.
+ */
+uint32 STORAGE_getSize(Storage_Device device)
+{
+	switch(device)
+	{
+	case STORAGE_INTERNAL_EEPROM:
+		return IEEPROM_SIZE;
+
+	case STORAGE_EXTERNAL_EEPROM:
+		return EEPROM_getSize();
+	}
+
+	return 0;
+}
+
+/*
+ * Description :
+ * Wait until all the pending writes of the memory are programmed.
+ */
+Storage_Status STORAGE_flush(Storage_Device device)
+{
+	switch(device)
+	{
+	case STORAGE_INTERNAL_EEPROM:
+		IEEPROM_flush();
+		return STORAGE_OK;
+
+	case STORAGE_EXTERNAL_EEPROM:
+		return (EEPROM_WB_flush() == SUCCESS) ? STORAGE_OK : STORAGE_DEVICE_ERROR;
+	}
+
+	return STORAGE_INVALID_RANGE;
+}
+
+/*
+ * Description :
+ * Return TRUE if the memory has no pending writes, so a read does not have
+ * to wait for a write cycle.
+ */
+uint8 STORAGE_isIdle(Storage_Device device)
+{
+	switch(device)
+	{
+	case STORAGE_INTERNAL_EEPROM:
+		return IEEPROM_isIdle();
+
+	case STORAGE_EXTERNAL_EEPROM:
+		return (EEPROM_WB_isEmpty() && EEPROM_isReady());
+	}
+
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Background task of the memories that are not interrupt driven,
+ * to be called while the system is idle.
+ */
+void STORAGE_task(void)
+{
+	/* the internal EEPROM is written by its ready interrupt, only the external one needs the idle time */
+	EEPROM_WB_task();
+}
@@ -0,0 +1,101 @@
+ /******************************************************************************
+ *
+ * Module: STORAGE
+ *
+ * File Name: storage.h
+ *
+ * Description: Header file for the common interface of the non-volatile memories
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#ifndef STORAGE_H_
+#define STORAGE_H_
+
+#include "../../std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Partitions of the external EEPROM (24C16, 2 KB), every module keeps to its own
+ * partition. The addresses are page aligned.
+ * 0x0000 - 0x03FF : audit log ring
+ * 0x0400 - 0x05FF : password record store
+ * 0x0600 - 0x07FF : free
+ */
+#define STORAGE_AUDIT_PARTITION_ADDR      0x0000
+#define STORAGE_AUDIT_PARTITION_SIZE      0x0400
+#define STORAGE_RECORDS_PARTITION_ADDR    0x0400
+#define STORAGE_RECORDS_PARTITION_SIZE    0x0200
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Memories behind the storage interface */
+typedef enum
+{
+	STORAGE_INTERNAL_EEPROM,	/* ATmega32 EEPROM: small, hot data, no bus transaction */
+	STORAGE_EXTERNAL_EEPROM		/* I2C EEPROM(s) behind the write-behind buffer: bulk data */
+}Storage_Device;
+
+typedef enum
+{
+	STORAGE_OK,
+	STORAGE_INVALID_RANGE,		/* the address range is outside the memory */
+	STORAGE_DEVICE_ERROR		/* the memory did not complete the operation */
+}Storage_Status;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Read size bytes starting at address, pending writes are already visible.
+ */
+Storage_Status STORAGE_read(Storage_Device device, uint32 address, uint8 *data, uint16 size);
+
+/*
+ * Description :
+ * Write size bytes starting at address. Both memories accept the data in RAM
+ * and program it in the background, a later read returns the new data.
+ */
+Storage_Status STORAGE_write(Storage_Device device, uint32 address, const uint8 *data, uint16 size);
+
+/*
+ * Description :
+ * Set size bytes starting at address to the erased value 0xFF.
+ */
+Storage_Status STORAGE_erase(Storage_Device device, uint32 address, uint16 size);
+
+/*
+ * Description :
+ * Return the size of the memory in bytes.
+ */
+uint32 STORAGE_getSize(Storage_Device device);
+
+/*
+ * Description :
+ * Wait until all the pending writes of the memory are programmed.
+ */
+Storage_Status STORAGE_flush(Storage_Device device);
+
+/*
+ * Description :
+ * Return TRUE if the memory has no pending writes, so a read does not have
+ * to wait for a write cycle.
+ */
+uint8 STORAGE_isIdle(Storage_Device device);
+
+/*
+ * Description :
+ * Background task of the memories that are not interrupt driven,
+ * to be called while the system is idle.
+ */
+void STORAGE_task(void);
+
+#endif /* STORAGE_H_ */
@@ -0,0 +1,157 @@
+ /******************************************************************************
+ *
+ * Module: Internal EEPROM
+ *
+ * File Name: internal_eeprom.c
+ *
+ * Description: Source file for the ATmega32 internal EEPROM driver
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#include "internal_eeprom.h"
+#include "../../common_macros.h"
+#include <avr/io.h>				/* to use the EEPROM registers */
+#include <avr/interrupt.h>		/* for EEPROM ready ISR */
+#include <avr/eeprom.h>			/* for the timed EEMWE/EEWE write sequence */
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+typedef struct
+{
+	uint16 address;
+	uint8 data;
+}IEEPROM_Pending_t;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* FIFO of the bytes waiting for the EEPROM ready interrupt */
+static volatile IEEPROM_Pending_t g_ieeprom_queue[IEEPROM_QUEUE_SIZE];
+static volatile uint8 g_ieeprom_head = 0;	/* next place to fill */
+static volatile uint8 g_ieeprom_tail = 0;	/* next byte to write */
+static volatile uint8 g_ieeprom_count = 0;
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+ISR(EE_RDY_vect)
+{
+	if(0 == g_ieeprom_count)
+	{
+		/* nothing left, the interrupt fires continuously while the EEPROM is ready */
+		CLEAR_BIT(EECR, EERIE);
+		return;
+	}
+
+	/* the previous write cycle is over (EEWE = 0) so this does not wait, the byte is
+	 * read first and a byte that already holds the value costs no write cycle */
+	eeprom_update_byte((uint8 *)g_ieeprom_queue[g_ieeprom_tail].address, g_ieeprom_queue[g_ieeprom_tail].data);
+
+	g_ieeprom_tail = (g_ieeprom_tail + 1) % IEEPROM_QUEUE_SIZE;
+	g_ieeprom_count--;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Queue the bytes to be written by the EEPROM ready interrupt and return
+ * without waiting for the write cycles (about 8.5ms per byte). If the queue is
+ * full the function waits for the interrupt to free a place.
+ * Return FALSE if the range is outside the EEPROM.
+ */
+uint8 IEEPROM_write(uint16 address, const uint8 *data, uint16 size)
+{
+	if(((uint32)address + size) > IEEPROM_SIZE)
+	{
+		return FALSE;
+	}
+
+	while(size--)
+	{
+		/* wait for the interrupt to make room */
+		while(g_ieeprom_count >= IEEPROM_QUEUE_SIZE);
+
+		/* keep the interrupt away while the queue is updated */
+		CLEAR_BIT(EECR, EERIE);
+
+		g_ieeprom_queue[g_ieeprom_head].address = address;
+		g_ieeprom_queue[g_ieeprom_head].data = *data;
+		g_ieeprom_head = (g_ieeprom_head + 1) % IEEPROM_QUEUE_SIZE;
+		g_ieeprom_count++;
+
+		SET_BIT(EECR, EERIE);
+
+		address++;
+		data++;
+	}
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Read the bytes from the EEPROM, the bytes still waiting in the queue are
+ * returned with their new value.
+ * Return FALSE if the range is outside the EEPROM.
+ */
+uint8 IEEPROM_read(uint16 address, uint8 *data, uint16 size)
+{
+	uint16 i;
+	uint8 index, pending;
+
+	if(((uint32)address + size) > IEEPROM_SIZE)
+	{
+		return FALSE;
+	}
+
+	for(i = 0; i < size; i++)
+	{
+		/* the EEPROM can not be read while the interrupt starts a write cycle */
+		CLEAR_BIT(EECR, EERIE);
+
+		data[i] = eeprom_read_byte((const uint8 *)(address + i));
+
+		/* the newest queued value of this address wins, the queue is scanned from the oldest */
+		index = g_ieeprom_tail;
+		for(pending = 0; pending < g_ieeprom_count; pending++)
+		{
+			if(g_ieeprom_queue[index].address == (address + i))
+			{
+				data[i] = g_ieeprom_queue[index].data;
+			}
+			index = (index + 1) % IEEPROM_QUEUE_SIZE;
+		}
+
+		if(g_ieeprom_count)
+		{
+			SET_BIT(EECR, EERIE);
+		}
+	}
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Return TRUE if no bytes are waiting to be written.
+ */
+uint8 IEEPROM_isIdle(void)
+{
+	return ((0 == g_ieeprom_count) && BIT_IS_CLEAR(EECR, EEWE)) ? TRUE : FALSE;
+}
+
+/*
+ * Description :
+ * Wait until all the queued bytes are written.
+ */
+void IEEPROM_flush(void)
+{
+	while(!IEEPROM_isIdle());
+}
@@ -0,0 +1,62 @@
+ /******************************************************************************
+ *
+ * Module: Internal EEPROM
+ *
+ * File Name: internal_eeprom.h
+ *
+ * Description: Header file for the ATmega32 internal EEPROM driver
+ *
+ * Author: Ali Hassan
+ *
+ *******************************************************************************/
+
+#ifndef INTERNAL_EEPROM_H_
+#define INTERNAL_EEPROM_H_
+
+#include "../../std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* ATmega32 internal EEPROM size in bytes */
+#define IEEPROM_SIZE              1024
+
+/* Number of bytes that can wait in RAM for the EEPROM ready interrupt */
+#define IEEPROM_QUEUE_SIZE        32
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Queue the bytes to be written by the EEPROM ready interrupt and return
+ * without waiting for the write cycles (about 8.5ms per byte). Bytes that already
+ * hold the new value are skipped by the interrupt without a write cycle. If the queue is
+ * full the function waits for the interrupt to free a place.
+ * Return FALSE if the range is outside the EEPROM.
+ */
+uint8 IEEPROM_write(uint16 address, const uint8 *data, uint16 size);
+
+/*
+ * Description :
+ * Read the bytes from the EEPROM, the bytes still waiting in the queue are
+ * returned with their new value.
+ * Return FALSE if the range is outside the EEPROM.
+ */
+uint8 IEEPROM_read(uint16 address, uint8 *data, uint16 size);
+
+/*
+ * Description :
+ * Return TRUE if no bytes are waiting to be written.
+ */
+uint8 IEEPROM_isIdle(void);
+
+/*
+ * Description :
+ * Wait until all the queued bytes are written.
+ */
+void IEEPROM_flush(void);
+
+#endif /* INTERNAL_EEPROM_H_ */
@@ -19,6 +19,32 @@
  *                                Definitions                                  *
  *******************************************************************************/
 
+/* This enum will be used to specify the prescaler used with Timer0 */
+typedef enum
+{
+	TIMER0_NO_CLOCK,
+	TIMER0_PRESCALER_1,
+	TIMER0_PRESCALER_8,
+	TIMER0_PRESCALER_64,
+	TIMER0_PRESCALER_256,
+	TIMER0_PRESCALER_1024,
+}Timer0_Prescaler;
+
+/* This enum will be used to specify the running mode of Timer0 */
+typedef enum
+{
+	TIMER0_NORMAL_MODE,
+	TIMER0_CTC_MODE
+}Timer0_Mode;
+
+/* This struct holds the initialization elements of Timer0 */
+typedef struct{
+	uint8 initial_value;
+	uint8 compare_value; // it will be used in compare mode only.
+	Timer0_Prescaler prescaler;
+	Timer0_Mode mode;
+} Timer0_Config_t;
+
 /* This enum will be used to specify the prescaler used with Timer1 */
 typedef enum
 {
@@ -50,6 +76,24 @@ typedef struct{
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
+/*
+ * Description :
+ * Initializes Timer0
+ */
+void Timer0_init(const Timer0_Config_t * Config_Ptr);
+
+/*
+ * Description :
+ * Disable Timer0
+ */
+void Timer0_deInit(void);
+
+/*
+ * Description :
+ * sets the Timer0 Call Back function address
+ */
+void Timer0_setCallBack(void(*a_ptr)(void));
+
 /*
  * Description :
  * Initializes the Timer driver
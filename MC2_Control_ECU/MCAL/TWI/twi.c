@@ -14,12 +14,74 @@
 
 #include "../../common_macros.h"
 #include <avr/io.h>
+#include <util/delay.h>
+
+/*******************************************************************************
+ *                      Bit Rate Calculation                                   *
+ *******************************************************************************/
+
+/*
+ * SCL = F_CPU / (16 + 2 * TWBR * 4^TWPS)
+ * The smallest pre-scaler that fits TWBR in 8 bits is selected and TWBR is
+ * rounded up, so the generated SCL never exceeds the required frequency.
+ */
+#define TWI_DIV_CEIL(a,b)        (((a) + (b) - 1UL) / (b))
+
+#if ((F_CPU / TWI_SCL_FREQUENCY) < 16UL)
+#error "TWI_SCL_FREQUENCY is too high for this F_CPU, SCL can not exceed F_CPU/16"
+#endif
+
+#define TWI_BIT_RATE_SPAN        (TWI_DIV_CEIL(F_CPU, TWI_SCL_FREQUENCY) - 16UL)
+
+#if (TWI_DIV_CEIL(TWI_BIT_RATE_SPAN, 2UL) <= 255UL)
+#define TWI_TWPS_VALUE           0
+#define TWI_PRESCALER            1UL
+#elif (TWI_DIV_CEIL(TWI_BIT_RATE_SPAN, 8UL) <= 255UL)
+#define TWI_TWPS_VALUE           1
+#define TWI_PRESCALER            4UL
+#elif (TWI_DIV_CEIL(TWI_BIT_RATE_SPAN, 32UL) <= 255UL)
+#define TWI_TWPS_VALUE           2
+#define TWI_PRESCALER            16UL
+#elif (TWI_DIV_CEIL(TWI_BIT_RATE_SPAN, 128UL) <= 255UL)
+#define TWI_TWPS_VALUE           3
+#define TWI_PRESCALER            64UL
+#else
+#error "TWI_SCL_FREQUENCY is too low for this F_CPU"
+#endif
+
+#define TWI_TWBR_VALUE           TWI_DIV_CEIL(TWI_BIT_RATE_SPAN, 2UL * TWI_PRESCALER)
+#define TWI_SCL_ACTUAL           (F_CPU / (16UL + 2UL * TWI_TWBR_VALUE * TWI_PRESCALER))
+
+#if ((TWI_SCL_FREQUENCY - TWI_SCL_ACTUAL) * 100UL > TWI_SCL_FREQUENCY * TWI_SCL_MAX_ERROR_PERCENT)
+#error "Generated SCL frequency deviates more than TWI_SCL_MAX_ERROR_PERCENT from TWI_SCL_FREQUENCY"
+#endif
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Set when the last bus operation did not complete within TWI_TIMEOUT_US */
+static uint8 g_twi_timeout = FALSE;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/*
+ * Wait for the TWINT flag with an upper bound of TWI_TIMEOUT_US,
+ * record the timeout so TWI_getStatus() reports it.
+ */
+static void TWI_waitForFlag(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
 
 void TWI_init(void)
 {
-    /* Bit Rate: 400.000 kbps using zero pre-scaler TWPS=00 and F_CPU=8Mhz */
-    TWBR = 0x02;
-	TWSR = 0x00;
+    /* Bit Rate: TWI_SCL_FREQUENCY using the pre-scaler and TWBR computed at compile time */
+    TWBR = (uint8)TWI_TWBR_VALUE;
+	TWSR = TWI_TWPS_VALUE;
 	
     /* Two Wire Bus address my address if any master device want to call me: 0x1 (used in case this MC is a slave device)
        General Call Recognition: Off */
@@ -38,7 +100,7 @@ void TWI_start(void)
     TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN);
     
     /* Wait for TWINT flag set in TWCR Register (start bit is send successfully) */
-    while(BIT_IS_CLEAR(TWCR,TWINT));
+    TWI_waitForFlag();
 }
 
 void TWI_stop(void)
@@ -61,7 +123,7 @@ void TWI_writeByte(uint8 data)
 	 */ 
     TWCR = (1 << TWINT) | (1 << TWEN);
     /* Wait for TWINT flag set in TWCR Register(data is send successfully) */
-    while(BIT_IS_CLEAR(TWCR,TWINT));
+    TWI_waitForFlag();
 }
 
 uint8 TWI_readByteWithACK(void)
@@ -73,7 +135,7 @@ uint8 TWI_readByteWithACK(void)
 	 */ 
     TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA);
     /* Wait for TWINT flag set in TWCR Register (data received successfully) */
-    while(BIT_IS_CLEAR(TWCR,TWINT));
+    TWI_waitForFlag();
     /* Read Data */
     return TWDR;
 }
@@ -86,7 +148,7 @@ uint8 TWI_readByteWithNACK(void)
 	 */
     TWCR = (1 << TWINT) | (1 << TWEN);
     /* Wait for TWINT flag set in TWCR Register (data received successfully) */
-    while(BIT_IS_CLEAR(TWCR,TWINT));
+    TWI_waitForFlag();
     /* Read Data */
     return TWDR;
 }
@@ -94,7 +156,73 @@ uint8 TWI_readByteWithNACK(void)
 uint8 TWI_getStatus(void)
 {
     uint8 status;
+
+    /* the hardware status is meaningless if the last operation never completed */
+    if(g_twi_timeout)
+    {
+        return TWI_TIMEOUT;
+    }
+
     /* masking to eliminate first 3 bits and get the last 5 bits (status bits) */
     status = TWSR & 0xF8;
     return status;
 }
+
+uint8 TWI_recoverBus(void)
+{
+    uint8 clocks;
+
+    /* Disable the TWI module to get back the control of SCL and SDA pins */
+    TWCR = 0;
+
+    /*
+     * Emulate open drain outputs: the PORT bit stays 0 and the line is pulled
+     * low by making the pin output, released high (external pull-up) by making it input
+     */
+    CLEAR_BIT(PORTC,TWI_SCL_PIN_ID);
+    CLEAR_BIT(PORTC,TWI_SDA_PIN_ID);
+    CLEAR_BIT(DDRC,TWI_SCL_PIN_ID);
+    CLEAR_BIT(DDRC,TWI_SDA_PIN_ID);
+    _delay_us(5);
+
+    /* Clock the slave out of the byte it is stuck in until it releases SDA */
+    for(clocks = 0; (clocks < TWI_RECOVERY_CLOCKS) && BIT_IS_CLEAR(PINC,TWI_SDA_PIN_ID); clocks++)
+    {
+        SET_BIT(DDRC,TWI_SCL_PIN_ID);   /* SCL low  */
+        _delay_us(5);
+        CLEAR_BIT(DDRC,TWI_SCL_PIN_ID); /* SCL high */
+        _delay_us(5);
+    }
+
+    /* Generate a stop condition: SDA rising while SCL is high */
+    SET_BIT(DDRC,TWI_SCL_PIN_ID);       /* SCL low  */
+    _delay_us(5);
+    SET_BIT(DDRC,TWI_SDA_PIN_ID);       /* SDA low  */
+    _delay_us(5);
+    CLEAR_BIT(DDRC,TWI_SCL_PIN_ID);     /* SCL high */
+    _delay_us(5);
+    CLEAR_BIT(DDRC,TWI_SDA_PIN_ID);     /* SDA high */
+    _delay_us(5);
+
+    /* Give the pins back to the TWI module */
+    g_twi_timeout = FALSE;
+    TWI_init();
+
+    return (BIT_IS_SET(PINC,TWI_SDA_PIN_ID) ? TRUE : FALSE);
+}
+
+static void TWI_waitForFlag(void)
+{
+    uint16 elapsed_us = 0;
+
+    g_twi_timeout = FALSE;
+    while(BIT_IS_CLEAR(TWCR,TWINT))
+    {
+        if(elapsed_us++ >= TWI_TIMEOUT_US)
+        {
+            g_twi_timeout = TRUE;
+            break;
+        }
+        _delay_us(1);
+    }
+}
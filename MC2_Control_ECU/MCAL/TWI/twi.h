@@ -19,15 +19,50 @@
  *                      Preprocessor Macros                                    *
  *******************************************************************************/
 
+/* SCL frequency presets */
+#define TWI_SCL_100KHZ    100000UL  /* standard mode, long cables */
+#define TWI_SCL_400KHZ    400000UL  /* fast mode */
+#define TWI_SCL_1MHZ      1000000UL /* fast mode plus, FRAM parts (needs F_CPU >= 16Mhz) */
+
+/* Required SCL frequency, TWBR and TWPS values are computed from it at compile time */
+#ifndef TWI_SCL_FREQUENCY
+#define TWI_SCL_FREQUENCY TWI_SCL_400KHZ
+#endif
+
+/* Maximum allowed deviation of the generated SCL frequency below the required one */
+#define TWI_SCL_MAX_ERROR_PERCENT 10
+
 /* I2C Status Bits in the TWSR Register */
+#define TWI_BUS_ERROR     0x00 /* illegal start/stop condition detected on the bus */
 #define TWI_START         0x08 /* start has been sent */
 #define TWI_REP_START     0x10 /* repeated start */
 #define TWI_MT_SLA_W_ACK  0x18 /* Master transmit ( slave address + Write request ) to slave + ACK received from slave. */
-#define TWI_MT_SLA_R_ACK  0x40 /* Master transmit ( slave address + Read request ) to slave + ACK received from slave. */
+#define TWI_MT_SLA_W_NACK 0x20 /* Master transmit ( slave address + Write request ) to slave + NACK received from slave. */
 #define TWI_MT_DATA_ACK   0x28 /* Master transmit data and ACK has been received from Slave. */
+#define TWI_MT_DATA_NACK  0x30 /* Master transmit data and NACK has been received from Slave. */
+#define TWI_ARB_LOST      0x38 /* Arbitration lost in slave address or data bytes. */
+#define TWI_MT_SLA_R_ACK  0x40 /* Master transmit ( slave address + Read request ) to slave + ACK received from slave. */
+#define TWI_MT_SLA_R_NACK 0x48 /* Master transmit ( slave address + Read request ) to slave + NACK received from slave. */
 #define TWI_MR_DATA_ACK   0x50 /* Master received data and send ACK to slave. */
 #define TWI_MR_DATA_NACK  0x58 /* Master received data but doesn't send ACK to slave. */
 
+/*
+ * Pseudo status returned by TWI_getStatus() when the last operation did not
+ * complete within TWI_TIMEOUT_US, the lower 3 bits of TWSR are always masked
+ * so it can never collide with a real status code.
+ */
+#define TWI_TIMEOUT       0x01
+
+/* Maximum time to wait for the TWINT flag of a single bus operation */
+#define TWI_TIMEOUT_US    1000
+
+/* ATmega32 TWI pins, driven as GPIOs during the bus recovery */
+#define TWI_SCL_PIN_ID    PC0
+#define TWI_SDA_PIN_ID    PC1
+
+/* Clock pulses needed to let any slave finish the byte it is shifting out */
+#define TWI_RECOVERY_CLOCKS 9
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -39,5 +74,14 @@ uint8 TWI_readByteWithACK(void);
 uint8 TWI_readByteWithNACK(void);
 uint8 TWI_getStatus(void);
 
+/*
+ * Description :
+ * Free a bus held by a slave which lost track of the transfer:
+ * 1. Disable the TWI module and take over SCL/SDA as open drain GPIOs.
+ * 2. Clock SCL up to TWI_RECOVERY_CLOCKS times until the slave releases SDA.
+ * 3. Generate a stop condition and re-initialize the TWI module.
+ * Return TRUE if SDA is released at the end, FALSE if the bus is still stuck.
+ */
+uint8 TWI_recoverBus(void);
 
 #endif /* TWI_H_ */
@@ -102,6 +102,15 @@ uint8 UART_recieveByte(void)
     return UDR;		
 }
 
+/*
+ * Description :
+ * Return TRUE if a received byte is waiting in the Rx buffer, without blocking.
+ */
+uint8 UART_isByteReceived(void)
+{
+	return (BIT_IS_SET(UCSRA,RXC) ? TRUE : FALSE);
+}
+
 /*
  * Description :
  * Send the required string through UART to the other UART device.
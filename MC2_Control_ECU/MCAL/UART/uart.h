@@ -69,6 +69,12 @@ void UART_sendByte(const uint8 data);
  */
 uint8 UART_recieveByte(void);
 
+/*
+ * Description :
+ * Return TRUE if a received byte is waiting in the Rx buffer, without blocking.
+ */
+uint8 UART_isByteReceived(void);
+
 /*
  * Description :
  * Send the required string through UART to the other UART device.